@@ -14,15 +14,34 @@ use x86_64::instructions::*;
 ///
 /// This function does not return.
 pub fn kstart() -> ! {
+    // BOOTBOOT starts every core here: the application processors go
+    // straight to their parking loop, only the BSP initializes the kernel
+    if !smp::is_bsp() {
+        smp::park_ap();
+    }
+
     // Initialize devices
     peripheral::init_peripherals();
+    smp::init_bsp();
+    timeline::mark("smp init");
+
+    // Build the physical frame allocator from the BOOTBOOT memory map
+    memory::init();
+    timeline::mark("memory init");
 
     // Check if framebuffer is available and print "hello"
     if let Some(ref mut fb) = *peripheral::FB.lock() {
         fb.puts("Visible: The framebuffer is correctly mapped.");
         fb.draw_screen_test();
     }
-    
+    // Boot is done: dump the timeline and go idle
+    timeline::mark("kstart idle");
+    timeline::report();
+
+    // Nothing drains the transmit ring while we sit in hlt, so push out
+    // whatever the boot log still has queued before parking
+    peripheral::COM2.lock().flush();
+
     loop {
         hlt();
     }
@@ -0,0 +1,95 @@
+use core::alloc::{GlobalAlloc, Layout};
+use core::ptr::null_mut;
+
+use spin::Mutex;
+
+use super::memory::{self, FRAME_SIZE};
+
+/// Number of slab size classes.
+const NUM_CLASSES: usize = 7;
+
+/// Block sizes the slab caches serve. Every class divides the frame size
+/// and blocks start on a multiple of their own size, so a block is always
+/// aligned at least to the class size.
+const CLASSES: [usize; NUM_CLASSES] = [32, 64, 128, 256, 512, 1024, 2048];
+
+/// Heads of the per-class free lists. A free block stores the physical
+/// address of the next free block in its first 8 bytes; RAM is identity
+/// mapped, so that address is directly dereferencable.
+struct Slabs {
+    free: [u64; NUM_CLASSES],
+}
+
+/// Mutex-protected free lists of all slab caches. Alloc and free are a
+/// pop and a push, so the lock is only ever held for a few instructions.
+static SLABS: Mutex<Slabs> = Mutex::new(Slabs { free: [0; NUM_CLASSES] });
+
+/// Picks the smallest class that can hold the layout, or `None` when the
+/// request is too big for the slabs and has to take whole frames.
+fn class_of(layout: &Layout) -> Option<usize> {
+    let need = if layout.size() > layout.align() { layout.size() } else { layout.align() };
+    CLASSES.iter().position(|&c| c >= need)
+}
+
+/// A slab/segregated-fit kernel heap on top of the frame allocator.
+///
+/// Small allocations come from per-size free lists in O(1); an empty list
+/// is refilled by slicing one fresh 4K frame into blocks. Allocations
+/// larger than the biggest class take physically contiguous frames.
+pub struct CluuAllocator;
+
+unsafe impl GlobalAlloc for CluuAllocator {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        match class_of(&layout) {
+            Some(c) => {
+                let mut slabs = SLABS.lock();
+                if slabs.free[c] == 0 {
+                    // slab empty: slice a fresh frame into blocks of this class
+                    let frame = match memory::alloc_frame() {
+                        Some(frame) => frame,
+                        None => return null_mut(),
+                    };
+                    let size = CLASSES[c] as u64;
+                    let mut at = frame;
+                    while at < frame + FRAME_SIZE {
+                        *(at as *mut u64) = slabs.free[c];
+                        slabs.free[c] = at;
+                        at += size;
+                    }
+                }
+                let block = slabs.free[c];
+                slabs.free[c] = *(block as *const u64);
+                block as *mut u8
+            }
+            None => {
+                // too big for the slabs: hand out whole contiguous frames
+                if layout.align() as u64 > FRAME_SIZE {
+                    return null_mut();
+                }
+                let count = (layout.size() + FRAME_SIZE as usize - 1) / FRAME_SIZE as usize;
+                match memory::alloc_frames(count) {
+                    Some(addr) => addr as *mut u8,
+                    None => null_mut(),
+                }
+            }
+        }
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        match class_of(&layout) {
+            Some(c) => {
+                let mut slabs = SLABS.lock();
+                *(ptr as *mut u64) = slabs.free[c];
+                slabs.free[c] = ptr as u64;
+            }
+            None => {
+                let count = (layout.size() + FRAME_SIZE as usize - 1) / FRAME_SIZE as usize;
+                memory::free_frames_at(ptr as u64, count);
+            }
+        }
+    }
+}
+
+/// The allocator behind the `alloc` crate.
+#[global_allocator]
+static ALLOCATOR: CluuAllocator = CluuAllocator;
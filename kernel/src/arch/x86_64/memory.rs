@@ -0,0 +1,283 @@
+use core::{ptr::addr_of, slice};
+
+use log::info;
+use spin::Mutex;
+
+use crate::bootboot::{bootboot, MMapEnt, MMAP_FREE};
+
+/// Size of a physical page frame in bytes.
+pub const FRAME_SIZE: u64 = 4096;
+
+/// How many cores the per-core frame caches are sized for.
+const MAX_CORES: usize = super::smp::MAX_CORES;
+
+/// Frames kept in a per-core cache; refills and spills move half of it
+/// through the global bitmap in one critical section.
+const CACHE_SIZE: usize = 64;
+
+/// Bitmap over all of physical RAM, one bit per frame, set while the frame
+/// is free. The bitmap storage itself is carved out of the first free
+/// region of the BOOTBOOT memory map that can hold it.
+struct BitmapAllocator {
+    bitmap: &'static mut [u64],
+    /// number of frames the bitmap covers
+    frames: usize,
+    /// rotating scan hint, so allocation does not rescan low memory
+    next: usize,
+    /// number of currently free frames
+    free: usize,
+}
+
+impl BitmapAllocator {
+    /// Takes one free frame out of the bitmap.
+    ///
+    /// # Returns
+    ///
+    /// Returns the physical address of the frame, or `None` when RAM ran out.
+    fn alloc_one(&mut self) -> Option<u64> {
+        if self.free == 0 {
+            return None;
+        }
+        let words = self.bitmap.len();
+        for i in 0..words {
+            let w = (self.next + i) % words;
+            if self.bitmap[w] != 0 {
+                let bit = self.bitmap[w].trailing_zeros() as usize;
+                self.bitmap[w] &= !(1u64 << bit);
+                self.free -= 1;
+                self.next = w;
+                return Some((w * 64 + bit) as u64 * FRAME_SIZE);
+            }
+        }
+        None
+    }
+
+    /// Puts the frame at the given physical address back into the bitmap.
+    fn free_one(&mut self, addr: u64) {
+        let frame = (addr / FRAME_SIZE) as usize;
+        if frame < self.frames && self.bitmap[frame / 64] & (1u64 << (frame % 64)) == 0 {
+            self.bitmap[frame / 64] |= 1u64 << (frame % 64);
+            self.free += 1;
+        }
+    }
+
+    /// Marks a single frame as free while building the initial bitmap.
+    fn mark_free(&mut self, frame: usize) {
+        if frame < self.frames && self.bitmap[frame / 64] & (1u64 << (frame % 64)) == 0 {
+            self.bitmap[frame / 64] |= 1u64 << (frame % 64);
+            self.free += 1;
+        }
+    }
+
+    /// Marks a single frame as used while building the initial bitmap.
+    fn mark_used(&mut self, frame: usize) {
+        if frame < self.frames && self.bitmap[frame / 64] & (1u64 << (frame % 64)) != 0 {
+            self.bitmap[frame / 64] &= !(1u64 << (frame % 64));
+            self.free -= 1;
+        }
+    }
+}
+
+/// A small per-core LIFO of recently allocated/freed frames. The common
+/// alloc/free only touches the executing core's cache, so the global
+/// bitmap lock is only taken for batch refills and spills.
+struct FrameCache {
+    frames: [u64; CACHE_SIZE],
+    len: usize,
+}
+
+/// Mutex-protected static instance of the global bitmap allocator.
+static FRAMES: Mutex<Option<BitmapAllocator>> = Mutex::new(None);
+
+const EMPTY_CACHE: Mutex<FrameCache> = Mutex::new(FrameCache { frames: [0; CACHE_SIZE], len: 0 });
+
+/// Per-core frame caches. Each core only ever locks its own entry.
+static CACHES: [Mutex<FrameCache>; MAX_CORES] = [EMPTY_CACHE; MAX_CORES];
+
+/// Index of the executing core's cache.
+#[inline]
+fn cpu_id() -> usize {
+    super::smp::core_id() % MAX_CORES
+}
+
+/// Builds the physical frame allocator from the BOOTBOOT memory map.
+///
+/// Must be called once from `kstart()` while the loader's identity mapping
+/// of physical RAM is still live, because the bitmap is addressed through
+/// its physical location.
+///
+/// # Panics
+///
+/// Panics when the memory map contains no usable RAM.
+pub fn init() {
+    let (num_ent, mmap_ptr) = unsafe {
+        ((bootboot.size as usize - 128) / 16, addr_of!(bootboot.mmap) as *const MMapEnt)
+    };
+
+    // the highest usable physical address decides how much the bitmap covers
+    let mut top: u64 = 0;
+    for i in 0..num_ent {
+        let ent = unsafe { *mmap_ptr.add(i) };
+        if ent.size & 0xF == MMAP_FREE as u64 {
+            let end = ent.ptr + (ent.size & !0xF);
+            if end > top {
+                top = end;
+            }
+        }
+    }
+    let frames = (top / FRAME_SIZE) as usize;
+    let words = (frames + 63) / 64;
+    let bitmap_bytes = ((words * 8) as u64 + FRAME_SIZE - 1) & !(FRAME_SIZE - 1);
+
+    // carve the bitmap storage out of the first free region that holds it;
+    // frame 0 is never used, so a zero address can mean "no frame"
+    let mut bitmap_at: u64 = 0;
+    for i in 0..num_ent {
+        let ent = unsafe { *mmap_ptr.add(i) };
+        let start = if ent.ptr == 0 { FRAME_SIZE } else { ent.ptr };
+        if ent.size & 0xF == MMAP_FREE as u64 && start + bitmap_bytes <= ent.ptr + (ent.size & !0xF) {
+            bitmap_at = start;
+            break;
+        }
+    }
+    if frames == 0 || bitmap_at == 0 {
+        panic!("No usable RAM in the BOOTBOOT memory map!");
+    }
+
+    let bitmap = unsafe { slice::from_raw_parts_mut(bitmap_at as *mut u64, words) };
+    for w in bitmap.iter_mut() {
+        *w = 0;
+    }
+    let mut alloc = BitmapAllocator { bitmap, frames, next: 0, free: 0 };
+
+    // everything the loader reports free becomes allocatable...
+    for i in 0..num_ent {
+        let ent = unsafe { *mmap_ptr.add(i) };
+        if ent.size & 0xF == MMAP_FREE as u64 {
+            let first = ((ent.ptr + FRAME_SIZE - 1) / FRAME_SIZE) as usize;
+            let last = ((ent.ptr + (ent.size & !0xF)) / FRAME_SIZE) as usize;
+            for f in first.max(1)..last {
+                alloc.mark_free(f);
+            }
+        }
+    }
+    // ...except the frames the bitmap itself lives in
+    for f in (bitmap_at / FRAME_SIZE) as usize..((bitmap_at + bitmap_bytes) / FRAME_SIZE) as usize {
+        alloc.mark_used(f);
+    }
+
+    info!(
+        "Frame allocator: {} MB usable RAM, {} KB bitmap at {:#x}",
+        alloc.free as u64 * FRAME_SIZE / (1024 * 1024),
+        bitmap_bytes / 1024,
+        bitmap_at
+    );
+    *FRAMES.lock() = Some(alloc);
+}
+
+/// Allocates one 4K physical frame.
+///
+/// The executing core's cache satisfies the common case; only a cache
+/// refill takes the global bitmap lock, and then for a whole batch.
+///
+/// # Returns
+///
+/// Returns the physical address of the frame, or `None` when RAM ran out.
+pub fn alloc_frame() -> Option<u64> {
+    let mut cache = CACHES[cpu_id()].lock();
+    if cache.len == 0 {
+        let mut frames = FRAMES.lock();
+        let alloc = frames.as_mut()?;
+        while cache.len < CACHE_SIZE / 2 {
+            match alloc.alloc_one() {
+                Some(addr) => {
+                    let at = cache.len;
+                    cache.frames[at] = addr;
+                    cache.len += 1;
+                }
+                None => break,
+            }
+        }
+        if cache.len == 0 {
+            return None;
+        }
+    }
+    cache.len -= 1;
+    Some(cache.frames[cache.len])
+}
+
+/// Returns a frame obtained from `alloc_frame()`.
+///
+/// Frees land in the executing core's cache and spill back to the global
+/// bitmap in batches when it fills up.
+///
+/// # Arguments
+///
+/// * `addr` - The physical address of the frame to free.
+pub fn free_frame(addr: u64) {
+    let mut cache = CACHES[cpu_id()].lock();
+    if cache.len == CACHE_SIZE {
+        let mut frames = FRAMES.lock();
+        if let Some(alloc) = frames.as_mut() {
+            while cache.len > CACHE_SIZE / 2 {
+                cache.len -= 1;
+                alloc.free_one(cache.frames[cache.len]);
+            }
+        }
+    }
+    let at = cache.len;
+    cache.frames[at] = addr;
+    cache.len += 1;
+}
+
+/// Allocates `count` physically contiguous frames with a first-fit scan
+/// over the bitmap. Much slower than `alloc_frame()`; meant for the rare
+/// large allocations of the kernel heap.
+///
+/// # Returns
+///
+/// Returns the physical address of the first frame, or `None`.
+pub fn alloc_frames(count: usize) -> Option<u64> {
+    let mut frames = FRAMES.lock();
+    let alloc = frames.as_mut()?;
+    let mut run = 0;
+    for f in 1..alloc.frames {
+        if alloc.bitmap[f / 64] & (1u64 << (f % 64)) != 0 {
+            run += 1;
+            if run == count {
+                let first = f + 1 - count;
+                for g in first..first + count {
+                    alloc.mark_used(g);
+                }
+                return Some(first as u64 * FRAME_SIZE);
+            }
+        } else {
+            run = 0;
+        }
+    }
+    None
+}
+
+/// Returns a contiguous range obtained from `alloc_frames()`.
+///
+/// # Arguments
+///
+/// * `addr` - The physical address of the first frame.
+/// * `count` - The number of frames in the range.
+pub fn free_frames_at(addr: u64, count: usize) {
+    let mut frames = FRAMES.lock();
+    if let Some(alloc) = frames.as_mut() {
+        for f in 0..count {
+            alloc.free_one(addr + f as u64 * FRAME_SIZE);
+        }
+    }
+}
+
+/// Number of frames currently free in the global bitmap, not counting the
+/// ones parked in per-core caches. Mainly for diagnostics.
+pub fn free_frames() -> usize {
+    match *FRAMES.lock() {
+        Some(ref alloc) => alloc.free,
+        None => 0,
+    }
+}
@@ -1 +1,5 @@
-pub mod peripheral;
\ No newline at end of file
+pub mod heap;
+pub mod memory;
+pub mod peripheral;
+pub mod smp;
+pub mod timeline;
\ No newline at end of file
@@ -0,0 +1,77 @@
+use core::fmt;
+
+use spin::Mutex;
+
+use super::FB;
+
+/// A scrolling text console on top of the framebuffer: tracks a cursor,
+/// handles newlines and wrapping, and scrolls by moving whole scanlines on
+/// the back buffer instead of re-rendering glyphs. A second `Writer`
+/// backend next to the serial one in `utils::writer`.
+pub struct FbConsole {
+    col: u32,
+    row: u32,
+}
+
+/// Mutex-protected static instance of the framebuffer console.
+pub static CONSOLE: Mutex<FbConsole> = Mutex::new(FbConsole { col: 0, row: 0 });
+
+impl fmt::Write for FbConsole {
+    /// Renders a string at the cursor, scrolling as needed. The framebuffer
+    /// lock is taken once per string and everything is drawn on the back
+    /// buffer, with a single flush at the end.
+    ///
+    /// # Arguments
+    ///
+    /// * `s` - The string to write.
+    fn write_str(&mut self, s: &str) -> fmt::Result {
+        let mut guard = FB.lock();
+        // no framebuffer (yet): silently drop, the serial log still has it
+        let fb = match *guard {
+            Some(ref mut fb) => fb,
+            None => return Ok(()),
+        };
+        let (cell_w, cell_h) = fb.glyph_size();
+        let cols = fb.width / cell_w;
+        let rows = fb.height / cell_h;
+        if cols == 0 || rows == 0 {
+            return Ok(());
+        }
+        for b in s.bytes() {
+            match b {
+                b'\n' => {
+                    self.col = 0;
+                    self.row += 1;
+                }
+                b'\r' => {
+                    self.col = 0;
+                }
+                8 | 0x7F => {
+                    if self.col > 0 {
+                        self.col -= 1;
+                        fb.draw_glyph(b' ', self.col, self.row);
+                    }
+                }
+                _ => {
+                    if self.col >= cols {
+                        self.col = 0;
+                        self.row += 1;
+                    }
+                    if self.row >= rows {
+                        // one big row copy on the back buffer, no re-rendering
+                        fb.scroll_up((self.row - rows + 1) * cell_h);
+                        self.row = rows - 1;
+                    }
+                    fb.draw_glyph(b, self.col, self.row);
+                    self.col += 1;
+                }
+            }
+            if self.row >= rows {
+                fb.scroll_up((self.row - rows + 1) * cell_h);
+                self.row = rows - 1;
+            }
+        }
+        fb.flush();
+        Ok(())
+    }
+}
@@ -1,23 +1,96 @@
-use core::{ptr::{addr_of, write_bytes}, slice};
+use core::{ptr::{addr_of, addr_of_mut, copy_nonoverlapping, write_bytes}, slice};
 
-use log::info;
+/// Largest video mode the static back buffer can hold (1024x768, 32 bpp).
+/// We have no heap allocator yet, so the buffer lives in .bss.
+const BACK_BUFFER_PIXELS: usize = 1024 * 768;
+
+/// Back buffer in ordinary write-back RAM. All drawing goes here first, and
+/// `flush()` copies only the changed region to the slow MMIO framebuffer.
+static mut BACK_BUFFER: [u32; BACK_BUFFER_PIXELS] = [0; BACK_BUFFER_PIXELS];
+
+/// Bounding box of the pixels touched since the last `flush()`, in back
+/// buffer storage coordinates (row 0 is the first scanline in memory).
+/// `x1`/`y1` are exclusive.
+struct DirtyRect {
+    x0: u32,
+    y0: u32,
+    x1: u32,
+    y1: u32
+}
+
+/// Upper bounds of the pre-decoded glyph cache; font.psf is 8x16 with 128
+/// glyphs, a font exceeding these falls back to bit testing in `draw_glyph()`.
+const GLYPH_CACHE_GLYPHS: usize = 256;
+const GLYPH_CACHE_WIDTH: usize = 8;
+const GLYPH_CACHE_HEIGHT: usize = 16;
+/// Pixels stored per cached row: the glyph plus the one blank spacing column.
+const GLYPH_CACHE_ROW: usize = GLYPH_CACHE_WIDTH + 1;
+
+/// Glyphs expanded into 32 bit pixel rows once at init time, so rendering a
+/// character is a plain row copy per scanline instead of per-pixel bit tests.
+/// Written only by `init_glyph_cache()` before the first `puts()` call.
+static mut GLYPH_CACHE: [u32; GLYPH_CACHE_GLYPHS * GLYPH_CACHE_HEIGHT * GLYPH_CACHE_ROW] =
+    [0; GLYPH_CACHE_GLYPHS * GLYPH_CACHE_HEIGHT * GLYPH_CACHE_ROW];
+static mut GLYPH_CACHE_READY: bool = false;
+
+/// Decodes every glyph of the embedded PSF2 font into `GLYPH_CACHE`. Called
+/// once from `init_peripherals()`; `draw_glyph()` keeps decoding on the fly
+/// until this ran (or forever, if the font does not fit the cache dimensions).
+pub fn init_glyph_cache() {
+    use bootboot::*;
+
+    let font: *const psf2_t = unsafe { addr_of!(_binary_font_psf_start) } as *const u64 as *const psf2_t;
+    let psf = unsafe { *font };
+    if psf.numglyph as usize > GLYPH_CACHE_GLYPHS
+        || psf.width as usize > GLYPH_CACHE_WIDTH
+        || psf.height as usize > GLYPH_CACHE_HEIGHT {
+        return;
+    }
+    let bpl = (psf.width + 7) / 8;
+    let glyph_start = (font as u64 + psf.headersize as u64) as *const u8;
+    for g in 0..psf.numglyph as usize {
+        let mut glyph = unsafe { glyph_start.add(g * psf.bytesperglyph as usize) };
+        for row in 0..psf.height as usize {
+            let base = (g * GLYPH_CACHE_HEIGHT + row) * GLYPH_CACHE_ROW;
+            let mut mask = 1u8 << (psf.width - 1);
+            for x in 0..psf.width as usize {
+                // the spacing column past the glyph stays 0 from the initializer
+                unsafe { GLYPH_CACHE[base + x] = if *glyph & mask > 0 { 0xFFFFFF } else { 0 }; }
+                mask >>= 1;
+            }
+            glyph = unsafe { glyph.add(bpl as usize) };
+        }
+    }
+    unsafe { GLYPH_CACHE_READY = true; }
+}
 
 pub struct FrameBuffer {
-    pub screen: &'static mut [u32], 
-    pub scanline: u32, 
-    pub width: u32, 
+    pub screen: &'static mut [u32],
+    back: Option<&'static mut [u32]>,
+    dirty: Option<DirtyRect>,
+    pub scanline: u32,
+    pub width: u32,
     pub height: u32
 }
 
 impl FrameBuffer {
     pub fn new(screen: *mut u32, scanline: u32, width: u32, height: u32) -> Result<FrameBuffer, &'static str> {
         //TODO: Initialization error logic, now just emit Result
+        let pixels = (scanline / 4 * height) as usize;
         Ok(FrameBuffer {
             screen: unsafe {
                 let size = (scanline * height) as usize; //get the size of the framebuffer
                 write_bytes(screen, 0, size); //init self.screen
-                slice::from_raw_parts_mut(screen, size) 
-            }, 
+                slice::from_raw_parts_mut(screen, size)
+            },
+            // Modes too big for the static buffer fall back to drawing
+            // straight into the MMIO framebuffer
+            back: if pixels <= BACK_BUFFER_PIXELS {
+                Some(unsafe { slice::from_raw_parts_mut(addr_of_mut!(BACK_BUFFER) as *mut u32, pixels) })
+            } else {
+                None
+            },
+            dirty: None,
             scanline, width, height }).map_err(|_:&'static str| "Error with Framebuffer mapping!")
         }
 
@@ -26,7 +99,7 @@ impl FrameBuffer {
         let s = self.scanline;
         let w = self.width;
         let h = self.height;
-    
+
         if s > 0 {
             // Cross-hair to see self.screen dimension detected correctly
             for y in 0..h {
@@ -37,14 +110,15 @@ impl FrameBuffer {
                 self.put_pixel(x, h / 2, 0x00FFFFFF)
             }
 
-            
+            self.flush();
         }
-
-        info!("Screentest was drawn.");
     }
 
     /// Puts a pixel of the specified color at the given coordinates (x, y) on the screen.
     ///
+    /// The pixel lands in the back buffer (or the framebuffer itself when the
+    /// mode is too big for one); call `flush()` to make it visible.
+    ///
     /// # Arguments
     ///
     /// * `x` - The x-coordinate of the pixel.
@@ -57,10 +131,168 @@ impl FrameBuffer {
     /// that the framebuffer is properly initialized.
     #[inline]
     fn put_pixel(&mut self, x: u32, y: u32, color: u32) {
-        // Write the color value to the framebuffer
-        *unsafe { self.screen.get_unchecked_mut(((self.height - 1 - y) * self.scanline / 4 + x) as usize) } = color;
+        let row = self.height - 1 - y;
+        let idx = (row * self.scanline / 4 + x) as usize;
+        // Write the color value to the back buffer
+        match &mut self.back {
+            Some(back) => *unsafe { back.get_unchecked_mut(idx) } = color,
+            None => *unsafe { self.screen.get_unchecked_mut(idx) } = color,
+        }
+        self.mark_dirty(x, x + 1, row, row + 1);
+    }
+
+    /// Grows the dirty rectangle to cover the given span (storage
+    /// coordinates, end exclusive).
+    #[inline]
+    fn mark_dirty(&mut self, x0: u32, x1: u32, y0: u32, y1: u32) {
+        match &mut self.dirty {
+            Some(rect) => {
+                if x0 < rect.x0 { rect.x0 = x0; }
+                if y0 < rect.y0 { rect.y0 = y0; }
+                if x1 > rect.x1 { rect.x1 = x1; }
+                if y1 > rect.y1 { rect.y1 = y1; }
+            },
+            None => self.dirty = Some(DirtyRect { x0, y0, x1, y1 }),
+        }
+    }
+
+    /// Copies the scanline spans touched since the last flush from the back
+    /// buffer to the MMIO framebuffer, using 64 bit (two pixel) stores. MMIO
+    /// is write-combining at best, so pushing only the dirty rectangle with
+    /// wide writes is much cheaper than repainting the whole screen.
+    pub fn flush(&mut self) {
+        let pitch = self.scanline / 4;
+        let rect = match self.dirty.take() {
+            Some(rect) => rect,
+            None => return,
+        };
+        // Without a back buffer the drawing already went to the framebuffer
+        let back = match &self.back {
+            Some(back) => back,
+            None => return,
+        };
+        let x1 = rect.x1.min(pitch);
+        for row in rect.y0..rect.y1 {
+            let start = (row * pitch + rect.x0) as usize;
+            let mut left = (x1 - rect.x0) as usize;
+            unsafe {
+                let mut src = back.as_ptr().add(start);
+                let mut dst = self.screen.as_mut_ptr().add(start);
+                // a single pixel first when the span starts unaligned, so
+                // that the 64 bit stores below are aligned
+                if left > 0 && (dst as usize) & 7 != 0 {
+                    dst.write_volatile(src.read());
+                    src = src.add(1);
+                    dst = dst.add(1);
+                    left -= 1;
+                }
+                while left >= 2 {
+                    (dst as *mut u64).write_volatile((src as *const u64).read_unaligned());
+                    src = src.add(2);
+                    dst = dst.add(2);
+                    left -= 2;
+                }
+                if left > 0 {
+                    dst.write_volatile(src.read());
+                }
+            }
+        }
+    }
+
+    /// Size of one character cell in pixels: the glyph width plus its one
+    /// blank spacing column, and the glyph height.
+    pub fn glyph_size(&self) -> (u32, u32) {
+        use bootboot::*;
+
+        let font: *const psf2_t = unsafe { addr_of!(_binary_font_psf_start) } as *const u64 as *const psf2_t;
+        let psf = unsafe { *font };
+        (psf.width + 1, psf.height)
     }
-   
+
+    /// Renders one glyph at the given character cell of the back buffer.
+    /// Shared by `puts()` and the scrolling console; call `flush()` when the
+    /// whole string is down.
+    ///
+    /// # Arguments
+    ///
+    /// * `ch` - The character to render.
+    /// * `col` - The character cell column.
+    /// * `row` - The character cell row.
+    pub fn draw_glyph(&mut self, ch: u8, col: u32, row: u32) {
+        use bootboot::*;
+
+        let font: *const psf2_t = unsafe { addr_of!(_binary_font_psf_start) } as *const u64 as *const psf2_t;
+        let psf = unsafe { *font };
+        let width = psf.width;
+        let height = psf.height;
+        let fb_scanline = unsafe { bootboot.fb_scanline };
+        let g = (ch as u32).min(psf.numglyph - 1) as usize;
+        let x0 = col * (width + 1);
+        let y0 = row * height;
+        let mut offs = y0 * fb_scanline + x0 * 4;
+
+        let buf: *mut u32 = match &mut self.back {
+            Some(back) => back.as_mut_ptr(),
+            None => self.screen.as_mut_ptr(),
+        };
+
+        if unsafe { GLYPH_CACHE_READY } {
+            // Fast path: the glyph was pre-expanded into pixel rows at init
+            // time, so each scanline is a single row copy
+            let cache = unsafe { addr_of!(GLYPH_CACHE) } as *const u32;
+            for r in 0..height as usize {
+                unsafe {
+                    copy_nonoverlapping(
+                        cache.add((g * GLYPH_CACHE_HEIGHT + r) * GLYPH_CACHE_ROW),
+                        buf.add((offs / 4) as usize),
+                        width as usize + 1);
+                }
+                offs += fb_scanline;
+            }
+        } else {
+            // Slow path: test the font bitmap bit by bit
+            let bpl = (width + 7) / 8;
+            let mut glyph = (font as u64 + psf.headersize as u64 + g as u64 * psf.bytesperglyph as u64) as *const u8;
+            for _ in 0..height {
+                let mut line = offs as u64;
+                let mut mask = 1u8 << (width - 1);
+                for _ in 0..width {
+                    let pixel_value = if unsafe { *glyph } & mask > 0 { 0xFFFFFF } else { 0 };
+                    unsafe { *buf.add((line / 4) as usize) = pixel_value; }
+                    mask >>= 1;
+                    line += 4;
+                }
+                unsafe { *buf.add((line / 4) as usize) = 0; }  // the blank spacing column
+                glyph = unsafe { glyph.offset(bpl as isize) };
+                offs += fb_scanline;
+            }
+        }
+
+        self.mark_dirty(x0, x0 + width + 1, y0, y0 + height);
+    }
+
+    /// Scrolls the pixel content up by `px` scanlines with one large row
+    /// copy on the drawing buffer, then clears the uncovered bottom stripe.
+    /// No glyphs are re-rendered; call `flush()` to make it visible.
+    ///
+    /// # Arguments
+    ///
+    /// * `px` - The number of scanlines to scroll up by.
+    pub fn scroll_up(&mut self, px: u32) {
+        let pitch = (self.scanline / 4) as usize;
+        let visible = pitch * self.height as usize;
+        let cut = pitch * px.min(self.height) as usize;
+        let buf: &mut [u32] = match &mut self.back {
+            Some(back) => back,
+            None => self.screen,
+        };
+        buf.copy_within(cut..visible, 0);
+        for pixel in &mut buf[visible - cut..visible] {
+            *pixel = 0;
+        }
+        self.mark_dirty(0, pitch as u32, 0, self.height);
+    }
+
     /// Display text on the self.screen using the PC self.screen Font.
     ///
     /// # Arguments
@@ -74,55 +306,9 @@ impl FrameBuffer {
     /// self.screen.puts("Hello, World!");
     /// ```
     pub fn puts(&mut self, string: &'static str) {
-        use bootboot::*;
-    
-        // Get the font structure pointer
-        let font: *mut psf2_t = unsafe { addr_of!(_binary_font_psf_start) } as *const u64 as *mut psf2_t;
-        let psf = unsafe { *font };
-    
-        // Extract font properties
-        let headersize = psf.headersize;          // Size of the font header
-        let numglyph = psf.numglyph;              // Number of glyphs in the font
-        let bytesperglyph = psf.bytesperglyph;    // Size of each glyph in bytes
-        let height = psf.height;                   // Height of each glyph
-        let width = psf.width;                     // Width of each glyph
-        let bpl = (width + 7) / 8;                 // Bytes per line (scanline) of each glyph
-        let fb_scanline = unsafe { bootboot.fb_scanline };  // Scanline length of the framebuffer
-    
-        
-    
-        // Calculate the starting address of the glyph data
-        let glyph_start_addr = (font as u64 + headersize as u64) as *mut u8;
-    
-        // Iterate over each character in the string
-        for (kx,s) in string.bytes().enumerate() {
-            // Calculate the offset of the glyph in the font data
-            let glyph_offset = (s as u32).min(numglyph - 1) * bytesperglyph;
-    
-            // Get a pointer to the glyph data
-            let mut glyph = unsafe { glyph_start_addr.offset(glyph_offset as isize) };
-    
-            // Calculate the starting offset in the framebuffer
-            let mut offs = kx as u32 * (width + 1) * 4;
-    
-            // Iterate over each line of the glyph
-            for _ in 0..height {
-                let mut line = offs as u64;  // Current line offset in the framebuffer
-                let mut mask = 1 << (width - 1);  // Bit mask to check each pixel of the glyph
-    
-                // Iterate over each pixel in the line
-                for _ in 0..width {
-                    let target_pixel = &mut self.screen[(line / 4) as usize];  // Get a mutable reference to the target pixel in the framebuffer
-                    let pixel_value = if unsafe { *glyph } & mask > 0 { 0xFFFFFF } else { 0 };  // Determine the pixel color based on the glyph data
-                    *target_pixel = pixel_value;  // Update the pixel value in the framebuffer
-                    mask >>= 1;  // Shift the mask to check the next pixel
-                    line += 4;  // Move to the next pixel in the line
-                }
-    
-                self.screen[(line / 4) as usize] = 0;  // Set the last pixel in the line to 0 (end of line)
-                glyph = unsafe { glyph.offset(bpl as isize) };  // Move to the next line of the glyph data
-                offs += fb_scanline;  // Move to the corresponding line in the framebuffer
-            }
+        for (kx, s) in string.bytes().enumerate() {
+            self.draw_glyph(s, kx as u32, 0);
         }
+        self.flush();
     }
 }
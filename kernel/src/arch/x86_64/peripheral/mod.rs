@@ -10,6 +10,7 @@ use crate::utils::logger;
 
 pub mod uart_16550;
 pub mod framebuffer;
+pub mod fb_console;
 
 /// Mutex-protected static instance of COM2 serial port.
 pub static COM2: Mutex<SerialPort<Pio<u8>>> = Mutex::new(SerialPort::<Pio<u8>>::new(0x2F8));
@@ -21,11 +22,17 @@ pub static FB: Mutex<Option<FrameBuffer>> = Mutex::new(None);
 ///
 /// This function initializes the COM2 serial port and the framebuffer.
 pub fn init_peripherals() {
+    super::timeline::mark("init_peripherals enter");
     COM2.lock().init();
     logger::init(true); // Init the logger engine, with clearing the screen
+    super::timeline::mark("logger init");
 
     // Now we can emit log messages
 
+    // Expand the PSF2 font into the glyph cache once, so that every later
+    // FrameBuffer::puts() renders from pre-decoded pixel rows
+    init_glyph_cache();
+
     match FrameBuffer::new(
         unsafe { addr_of_mut!(fb) } as *mut u32,
         unsafe { bootboot.fb_scanline },
@@ -39,6 +46,8 @@ pub fn init_peripherals() {
         },
         Err(err) => panic!("{}", err),
     }
+    super::timeline::mark("framebuffer init");
+    super::timeline::mark("init_peripherals exit");
 
     // *FB.lock() = Some(FrameBuffer::new(
     //     unsafe { addr_of_mut!(fb) } as *mut u32,
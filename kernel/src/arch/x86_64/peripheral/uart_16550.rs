@@ -25,6 +25,14 @@ bitflags! {
     }
 }
 
+/// Size of the transmit ring buffer. Must be a power of two, so the
+/// monotonically growing head/tail indices can be masked into it.
+const TX_RING_SIZE: usize = 1024;
+
+/// Depth of the 16550 transmit FIFO: once the holding register reports
+/// empty, this many bytes can be pushed without polling again.
+const TX_FIFO_SIZE: usize = 16;
+
 /// Serial port representation.
 pub struct SerialPort<T: Io> {
     data: T,            // Data register, read to receive, write to send
@@ -35,6 +43,9 @@ pub struct SerialPort<T: Io> {
     line_sts: ReadOnly<T>,  // Line status
     #[allow(dead_code)]
     modem_sts: ReadOnly<T>, // Modem status, not used right now
+    tx_buf: [u8; TX_RING_SIZE], // Transmit ring: write() queues here and returns
+    tx_head: usize,     // Next free slot (only ever incremented)
+    tx_tail: usize,     // Next byte to hand to the UART
 }
 
 #[cfg(any(target_arch = "x86", target_arch = "x86_64"))]
@@ -57,6 +68,9 @@ impl SerialPort<Pio<u8>> {
             modem_ctrl: Pio::new(base + 4),
             line_sts: ReadOnly::new(Pio::new(base + 5)),
             modem_sts: ReadOnly::new(Pio::new(base + 6)),
+            tx_buf: [0; TX_RING_SIZE],
+            tx_head: 0,
+            tx_tail: 0,
         }
     }
 }
@@ -102,35 +116,94 @@ where
     //     }
     // }
 
+    /// Moves queued bytes into the UART without waiting: if the transmit
+    /// holding register is empty, a full FIFO load goes out as one string
+    /// I/O burst, so a FIFO's worth of bytes costs one status poll and one
+    /// `rep outs` instead of sixteen separate port writes.
+    fn drain(&mut self) {
+        if self.tx_head == self.tx_tail || !self.line_sts().contains(LineStsFlags::OUTPUT_EMPTY) {
+            return;
+        }
+        let n = TX_FIFO_SIZE.min(self.tx_head.wrapping_sub(self.tx_tail));
+        let mut chunk: [T::Value; TX_FIFO_SIZE] = [T::Value::from(0u8); TX_FIFO_SIZE];
+        for i in 0..n {
+            chunk[i] = self.tx_buf[self.tx_tail.wrapping_add(i) & (TX_RING_SIZE - 1)].into();
+        }
+        self.tx_tail = self.tx_tail.wrapping_add(n);
+        self.data.write_slice(&chunk[..n]);
+    }
+
+    /// Queues a byte in the transmit ring. Only blocks when the ring is
+    /// full, and then just long enough for the FIFO to take another burst.
+    fn enqueue(&mut self, data: u8) {
+        while self.tx_head.wrapping_sub(self.tx_tail) >= TX_RING_SIZE {
+            self.drain();
+        }
+        self.tx_buf[self.tx_head & (TX_RING_SIZE - 1)] = data;
+        self.tx_head = self.tx_head.wrapping_add(1);
+    }
+
+    /// Blocks until every queued byte has left the UART. Panic and other
+    /// last-words paths must call this, everything else can rely on later
+    /// writes draining the ring as a side effect.
+    pub fn flush(&mut self) {
+        while self.tx_head != self.tx_tail {
+            self.drain();
+        }
+        while !self.line_sts().contains(LineStsFlags::OUTPUT_EMPTY) {}
+    }
+
     /// Sends a byte of data through the serial port.
     ///
     /// # Arguments
     ///
     /// * `data` - The data byte to send.
     pub fn send(&mut self, data: u8) {
-        while !self.line_sts().contains(LineStsFlags::OUTPUT_EMPTY) {}
-        self.data.write(data.into())
+        self.enqueue(data);
+        self.drain();
     }
 
-    /// Writes a byte of data to the serial port.
-    ///
-    /// # Arguments
-    ///
-    /// * `b` - The byte of data to write.
-    pub fn write(&mut self, b: u8) {
+    /// Queues one byte with the usual terminal translation: backspace and
+    /// delete rub the previous character out, newline becomes CR LF.
+    fn enqueue_translated(&mut self, b: u8) {
         match b {
             8 | 0x7F => {
-                self.send(8);
-                self.send(b' ');
-                self.send(8);
+                self.enqueue(8);
+                self.enqueue(b' ');
+                self.enqueue(8);
             }
             b'\n' => {
-                self.send(b'\r');
-                self.send(b'\n');
+                self.enqueue(b'\r');
+                self.enqueue(b'\n');
             }
             _ => {
-                self.send(b);
+                self.enqueue(b);
             }
         }
     }
+
+    /// Writes a byte of data to the serial port. The byte only lands in the
+    /// transmit ring; it goes out on the wire as the FIFO drains.
+    ///
+    /// # Arguments
+    ///
+    /// * `b` - The byte of data to write.
+    pub fn write(&mut self, b: u8) {
+        self.enqueue_translated(b);
+        self.drain();
+    }
+
+    /// Writes a whole buffer to the serial port: everything is queued first
+    /// and the UART is topped up once at the end, so a message costs one
+    /// string I/O burst rather than a drain attempt per byte.
+    ///
+    /// # Arguments
+    ///
+    /// * `data` - The bytes to write.
+    pub fn write_buf(&mut self, data: &[u8]) {
+        for &b in data {
+            self.enqueue_translated(b);
+        }
+        self.drain();
+    }
 }
@@ -0,0 +1,95 @@
+use core::arch::asm;
+use core::arch::x86_64::__cpuid;
+use core::ptr::addr_of;
+use core::sync::atomic::{AtomicBool, AtomicU64, AtomicUsize, Ordering};
+
+use log::info;
+use x86_64::instructions::hlt;
+
+use crate::bootboot::bootboot;
+
+/// How many cores the per-CPU structures are sized for.
+pub const MAX_CORES: usize = 16;
+
+/// Stack size handed to each parked application processor. BOOTBOOT only
+/// gives every core a 1K slice below `_start`, which is too tight to ever
+/// run real work on.
+const AP_STACK_SIZE: usize = 16 * 1024;
+
+/// Dedicated AP stacks; core n parks on the top of `AP_STACKS[n]`.
+static mut AP_STACKS: [[u8; AP_STACK_SIZE]; MAX_CORES] = [[0; AP_STACK_SIZE]; MAX_CORES];
+
+/// Per-CPU data area. Everything in here is only ever written by the core
+/// owning the slot, so plain relaxed atomics are enough.
+pub struct PerCpu {
+    /// APIC id of the core that claimed this slot
+    pub id: AtomicUsize,
+    /// set once the core reached its parking loop (the BSP sets it when
+    /// it finished initialization)
+    pub online: AtomicBool,
+    /// reserved for the scheduler: the run queue this core works on
+    pub run_queue: AtomicU64,
+}
+
+const OFFLINE: PerCpu = PerCpu {
+    id: AtomicUsize::new(0),
+    online: AtomicBool::new(false),
+    run_queue: AtomicU64::new(0),
+};
+
+/// One slot per core, indexed by `core_id()`.
+pub static CPUS: [PerCpu; MAX_CORES] = [OFFLINE; MAX_CORES];
+
+/// The executing core's APIC id, straight from cpuid leaf 1.
+#[inline]
+pub fn core_id() -> usize {
+    (unsafe { __cpuid(1) }.ebx >> 24) as usize
+}
+
+/// Whether the executing core is the bootstrap processor. BOOTBOOT starts
+/// every core in `_start`, so this is the very first question to ask.
+#[inline]
+pub fn is_bsp() -> bool {
+    core_id() == unsafe { bootboot.bspid } as usize
+}
+
+/// Number of cores that checked in so far.
+pub fn online_cores() -> usize {
+    CPUS.iter().filter(|cpu| cpu.online.load(Ordering::Relaxed)).count()
+}
+
+/// Marks the bootstrap processor online and reports what the loader
+/// started. Called by the BSP once the logger is up.
+pub fn init_bsp() {
+    let id = core_id();
+    CPUS[id % MAX_CORES].id.store(id, Ordering::Relaxed);
+    CPUS[id % MAX_CORES].online.store(true, Ordering::Relaxed);
+    info!(
+        "SMP: {} cores started by the loader, BSP is core {}",
+        unsafe { bootboot.numcores },
+        id
+    );
+}
+
+/// Parks an application processor: claims its per-CPU slot, switches to a
+/// dedicated stack and halts. `hlt` resumes on any interrupt, so an IPI
+/// can wake the core into scheduled work later; until then it re-halts.
+///
+/// # Returns
+///
+/// This function does not return.
+pub fn park_ap() -> ! {
+    let id = core_id();
+    let slot = id % MAX_CORES;
+    CPUS[slot].id.store(id, Ordering::Relaxed);
+    CPUS[slot].online.store(true, Ordering::Relaxed);
+    unsafe {
+        // leave the loader's 1K boot stack for one of our own; parking
+        // never returns, so nothing of the old stack is needed again
+        let top = (addr_of!(AP_STACKS[slot]) as u64 + AP_STACK_SIZE as u64) & !0xF;
+        asm!("mov rsp, {}", in(reg) top);
+    }
+    loop {
+        hlt();
+    }
+}
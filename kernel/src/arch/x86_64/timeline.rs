@@ -0,0 +1,81 @@
+use core::arch::x86_64::_rdtsc;
+
+use log::info;
+use spin::Mutex;
+
+use super::smp;
+
+/// Maximum number of recorded boot phase marks.
+const MAX_MARKS: usize = 32;
+
+/// Fixed-size table of named cycle counter stamps, in the order the boot
+/// path recorded them.
+struct Timeline {
+    names: [&'static str; MAX_MARKS],
+    stamps: [u64; MAX_MARKS],
+    len: usize,
+}
+
+/// Mutex-protected static instance of the boot timeline.
+static TIMELINE: Mutex<Timeline> = Mutex::new(Timeline {
+    names: [""; MAX_MARKS],
+    stamps: [0; MAX_MARKS],
+    len: 0,
+});
+
+/// Records a named boot phase mark with the current `rdtsc` value.
+///
+/// Safe to call before the logger is up, since it only stores the stamp.
+/// Only the BSP records: every core runs `_start`, but one timeline full
+/// of interleaved AP marks would be useless. Marks beyond the table size
+/// are dropped.
+///
+/// # Arguments
+///
+/// * `name` - The phase name to record, shown verbatim in the report.
+pub fn mark(name: &'static str) {
+    let stamp = unsafe { _rdtsc() };
+    if !smp::is_bsp() {
+        return;
+    }
+    let mut tl = TIMELINE.lock();
+    if tl.len < MAX_MARKS {
+        let at = tl.len;
+        tl.names[at] = name;
+        tl.stamps[at] = stamp;
+        tl.len += 1;
+    }
+}
+
+/// Dumps the recorded timeline through the logger, with every mark's cycle
+/// distance from `_start` and from the previous mark. Called once when the
+/// boot path is about to go idle.
+pub fn report() {
+    let tl = TIMELINE.lock();
+    if tl.len == 0 {
+        return;
+    }
+    info!("Boot timeline, cycles since start / since previous mark:");
+    for i in 0..tl.len {
+        info!(
+            "  {:>12} {:>12}  {}",
+            tl.stamps[i] - tl.stamps[0],
+            if i > 0 { tl.stamps[i] - tl.stamps[i - 1] } else { 0 },
+            tl.names[i]
+        );
+    }
+}
+
+/// Records a named mark on the boot timeline with `rdtsc`.
+///
+/// # Examples
+///
+/// ```rust
+/// boot_mark!("memory init");
+/// ```
+#[macro_export]
+macro_rules! boot_mark {
+    ($name:expr) => {
+        $crate::arch::x86_64::timeline::mark($name)
+    };
+}
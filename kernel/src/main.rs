@@ -40,7 +40,7 @@ extern crate x86_64;
 extern crate spin;
 extern crate bitflags;
 extern crate log;
-//extern crate alloc;
+extern crate alloc;
 
 
 use core::panic::PanicInfo;
@@ -64,7 +64,10 @@ pub use log::{debug, error, info, set_max_level, warn};
 ///Entry point, called by BOOTBOOT Loader *
 #[no_mangle] // don't mangle the name of this function
 fn _start() -> ! {
-   
+
+    // first stamp on the boot timeline
+    boot_mark!("_start");
+
     //start kernel
     kstart();
     
@@ -78,6 +81,9 @@ fn _start() -> ! {
 fn panic(info: &PanicInfo) -> ! {
     serial_println!("Error: {}", info);
 
+    // Make sure the message actually left the transmit ring before halting
+    arch::x86_64::peripheral::COM2.lock().flush();
+
     // Enter an infinite loop to halt the execution
     loop {
         hlt();
@@ -12,6 +12,36 @@ pub trait Io {
     /// Writes the value to the I/O interface.
     fn write(&mut self, value: Self::Value);
 
+    /// Reads a whole buffer from the I/O interface.
+    ///
+    /// The default is one `read()` per element; implementations with string
+    /// I/O instructions override this with a single batched transfer.
+    ///
+    /// # Arguments
+    ///
+    /// * `buf` - The buffer to fill.
+    #[inline(always)]
+    fn read_slice(&self, buf: &mut [Self::Value]) {
+        for value in buf.iter_mut() {
+            *value = self.read();
+        }
+    }
+
+    /// Writes a whole buffer to the I/O interface.
+    ///
+    /// The default is one `write()` per element; implementations with string
+    /// I/O instructions override this with a single batched transfer.
+    ///
+    /// # Arguments
+    ///
+    /// * `buf` - The buffer to write.
+    #[inline(always)]
+    fn write_slice(&mut self, buf: &[Self::Value]) {
+        for &value in buf.iter() {
+            self.write(value);
+        }
+    }
+
     /// Reads the value from the I/O interface and checks if the specified flags are set.
     ///
     /// # Arguments
@@ -57,6 +57,38 @@ impl Io for Pio<u8> {
             asm!("out dx, al", in("dx") self.port, in("al") value, options(nostack, nomem, preserves_flags));
         }
     }
+
+    /// Read a whole buffer from the port with a single `rep insb`.
+    ///
+    /// # Arguments
+    ///
+    /// * `buf` - The buffer to fill.
+    #[inline(always)]
+    fn read_slice(&self, buf: &mut [u8]) {
+        unsafe {
+            asm!("rep insb",
+                in("dx") self.port,
+                inout("rdi") buf.as_mut_ptr() => _,
+                inout("rcx") buf.len() => _,
+                options(nostack, preserves_flags));
+        }
+    }
+
+    /// Write a whole buffer to the port with a single `rep outsb`.
+    ///
+    /// # Arguments
+    ///
+    /// * `buf` - The buffer to write.
+    #[inline(always)]
+    fn write_slice(&mut self, buf: &[u8]) {
+        unsafe {
+            asm!("rep outsb",
+                in("dx") self.port,
+                inout("rsi") buf.as_ptr() => _,
+                inout("rcx") buf.len() => _,
+                options(nostack, preserves_flags));
+        }
+    }
 }
 
 /// Read/Write for word PIO
@@ -88,6 +120,38 @@ impl Io for Pio<u16> {
             asm!("out dx, ax", in("dx") self.port, in("ax") value, options(nostack, nomem, preserves_flags));
         }
     }
+
+    /// Read a whole buffer from the port with a single `rep insw`.
+    ///
+    /// # Arguments
+    ///
+    /// * `buf` - The buffer to fill.
+    #[inline(always)]
+    fn read_slice(&self, buf: &mut [u16]) {
+        unsafe {
+            asm!("rep insw",
+                in("dx") self.port,
+                inout("rdi") buf.as_mut_ptr() => _,
+                inout("rcx") buf.len() => _,
+                options(nostack, preserves_flags));
+        }
+    }
+
+    /// Write a whole buffer to the port with a single `rep outsw`.
+    ///
+    /// # Arguments
+    ///
+    /// * `buf` - The buffer to write.
+    #[inline(always)]
+    fn write_slice(&mut self, buf: &[u16]) {
+        unsafe {
+            asm!("rep outsw",
+                in("dx") self.port,
+                inout("rsi") buf.as_ptr() => _,
+                inout("rcx") buf.len() => _,
+                options(nostack, preserves_flags));
+        }
+    }
 }
 
 /// Read/Write for doubleword PIO
@@ -119,4 +183,36 @@ impl Io for Pio<u32> {
             asm!("out dx, eax", in("dx") self.port, in("eax") value, options(nostack, nomem, preserves_flags));
         }
     }
+
+    /// Read a whole buffer from the port with a single `rep insd`.
+    ///
+    /// # Arguments
+    ///
+    /// * `buf` - The buffer to fill.
+    #[inline(always)]
+    fn read_slice(&self, buf: &mut [u32]) {
+        unsafe {
+            asm!("rep insd",
+                in("dx") self.port,
+                inout("rdi") buf.as_mut_ptr() => _,
+                inout("rcx") buf.len() => _,
+                options(nostack, preserves_flags));
+        }
+    }
+
+    /// Write a whole buffer to the port with a single `rep outsd`.
+    ///
+    /// # Arguments
+    ///
+    /// * `buf` - The buffer to write.
+    #[inline(always)]
+    fn write_slice(&mut self, buf: &[u32]) {
+        unsafe {
+            asm!("rep outsd",
+                in("dx") self.port,
+                inout("rsi") buf.as_ptr() => _,
+                inout("rcx") buf.len() => _,
+                options(nostack, preserves_flags));
+        }
+    }
 }
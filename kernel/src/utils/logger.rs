@@ -1,20 +1,26 @@
 use core::fmt::Write;
 
-use log::{Record, Level, Metadata, LevelFilter};
+use log::{Record, Metadata, LevelFilter};
 
 /// Custom logger implementation for CluuLogger.
 struct CluuLogger;
 
 impl log::Log for CluuLogger {
-    /// Checks if the given log level is enabled.
+    /// Checks if the given log level is enabled. This is just an atomic
+    /// load and a compare, so records disabled by `log::set_max_level()`
+    /// bail out before any formatting work happens.
     fn enabled(&self, metadata: &Metadata) -> bool {
-        metadata.level() <= Level::Info
+        metadata.level() <= log::max_level()
     }
 
-    /// Logs the record by printing it to the console.
+    /// Logs the record by printing it to the serial port and, once the
+    /// framebuffer is up, to the on-screen console as well.
     fn log(&self, record: &Record) {
         if self.enabled(record.metadata()) {
             serial_println!("[{}] {}", record.level(), record.args());
+            let _ = writeln!(
+                crate::arch::x86_64::peripheral::fb_console::CONSOLE.lock(),
+                "[{}] {}", record.level(), record.args());
         }
     }
 
@@ -36,7 +36,11 @@
 macro_rules! print {
     ($($arg:tt)*) => ({
         use core::fmt::Write;
-        let _ = $crate::utils::writer::Writer::new().write_fmt(format_args!($($arg)*)).expect("Printing fmt failed");
+        // format into a stack buffer first: the serial lock is only taken
+        // in flush(), for the short time queueing the line takes
+        let mut buf = $crate::utils::writer::BufferedWriter::new();
+        let _ = buf.write_fmt(format_args!($($arg)*)).expect("Printing fmt failed");
+        buf.flush();
     });
 }
 
@@ -42,6 +42,59 @@ impl<'a> Writer<'a> {
     }
 }
 
+/// Size of a line buffer; over-long records get truncated.
+const LINE_BUF_SIZE: usize = 512;
+
+/// A writer that formats into a stack buffer first and hands the finished
+/// line to the serial port afterwards. Unlike `Writer`, which keeps the
+/// `COM2` mutex locked for the whole formatting operation, this one only
+/// takes the lock in `flush()` for as long as queueing the bytes takes.
+pub struct BufferedWriter {
+    buf: [u8; LINE_BUF_SIZE],
+    len: usize,
+}
+
+impl BufferedWriter {
+    /// Creates a new, empty line buffer.
+    ///
+    /// # Example
+    ///
+    /// ```rust
+    /// let mut writer = BufferedWriter::new();
+    /// ```
+    pub fn new() -> BufferedWriter {
+        BufferedWriter {
+            buf: [0; LINE_BUF_SIZE],
+            len: 0,
+        }
+    }
+
+    /// Pushes the buffered line to the serial port in one short critical
+    /// section and empties the buffer.
+    pub fn flush(&mut self) {
+        COM2.lock().write_buf(&self.buf[..self.len]);
+        self.len = 0;
+    }
+}
+
+impl fmt::Write for BufferedWriter {
+    /// Appends a string to the line buffer, truncating if it does not fit.
+    ///
+    /// # Arguments
+    ///
+    /// * `s` - The string to append.
+    fn write_str(&mut self, s: &str) -> fmt::Result {
+        for &byte in s.as_bytes() {
+            if self.len == LINE_BUF_SIZE {
+                break;
+            }
+            self.buf[self.len] = byte;
+            self.len += 1;
+        }
+        Ok(())
+    }
+}
+
 impl<'a> fmt::Write for Writer<'a> {
     /// Writes a string to the serial port.
     ///
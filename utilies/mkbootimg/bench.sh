@@ -0,0 +1,79 @@
+#!/bin/sh
+#
+# mkbootimg/bench.sh
+#
+# Copyright (C) 2017 - 2021 bzt (bztsrc@gitlab)
+#
+# Permission is hereby granted, free of charge, to any person
+# obtaining a copy of this software and associated documentation
+# files (the "Software"), to deal in the Software without
+# restriction, including without limitation the rights to use, copy,
+# modify, merge, publish, distribute, sublicense, and/or sell copies
+# of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be
+# included in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+# MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+# NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+# HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+# WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+#
+# This file is part of the BOOTBOOT Protocol package.
+# @brief Benchmark harness, run it with "make bench"
+#
+# Generates a synthetic initrd tree with geninitrd and runs the full image
+# pipeline (walk, archive, ESP, GPT, write, verify) once per file system
+# driver, reporting the per-stage profile in a stable, diffable format on
+# stdout. Tunables come from the environment:
+#
+#   BENCH_FILES    number of files in the tree (default 2000)
+#   BENCH_AVGSIZE  average file size in bytes (default 16384)
+#   BENCH_DUP      percentage of duplicate files (default 20)
+#   BENCH_SEED     random seed, same seed gives the same tree (default 12345)
+#   BENCH_DRIVERS  drivers to run (default "cpio tar echfs")
+#
+# Only archive style drivers can pack an initrd inside the boot partition
+# (fat, minix, ext2 and lean are partition formats), and of those jamesm
+# (63 files) and FS/Z (23 entries per embedded directory) are too small
+# for a benchmark tree, which leaves cpio, tar and echfs as defaults.
+
+FILES="${BENCH_FILES:-2000}"
+AVGSIZE="${BENCH_AVGSIZE:-16384}"
+DUP="${BENCH_DUP:-20}"
+SEED="${BENCH_SEED:-12345}"
+DRIVERS="${BENCH_DRIVERS:-cpio tar echfs}"
+
+here="$(cd "$(dirname "$0")" && pwd)"
+work="$(mktemp -d)" || exit 1
+trap 'rm -rf "$work"' EXIT INT TERM
+
+"$here/geninitrd" "$work/rd" "$FILES" "$AVGSIZE" "$DUP" "$SEED" || exit 1
+printf 'kernel=sys/core\n' > "$work/config"
+
+echo "bench: files=$FILES avgsize=$AVGSIZE dup=$DUP seed=$SEED"
+for drv in $DRIVERS; do
+    safe="$(printf '%s' "$drv" | tr '/' '_')"
+    cat > "$work/$safe.json" <<EOF
+{
+    "diskguid": "12345678-1234-1234-1234-123456789ABC",
+    "disksize": 256,
+    "config": "$work/config",
+    "initrd": { "type": "$drv", "gzip": false, "directory": "$work/rd" },
+    "partitions": [
+        { "type": "boot", "size": 16 }
+    ]
+}
+EOF
+    "$here/mkbootimg" --profile --verify "$work/$safe.json" "$work/$safe.img" 2>&1 >/dev/null | \
+        sed -n "s|^mkbootimg-profile: |driver=$drv |p"
+    if [ ! -f "$work/$safe.img" ]; then
+        echo "driver=$drv FAILED"
+    fi
+    rm -f "$work/$safe.img"
+done
@@ -81,8 +81,8 @@ int main(int argc, char **argv)
                 compress2(buff2, &len, buff, size, 9);
                 free(buff); buff = buff2;
             } else len = size;
-            fprintf(h, "#define sizeof_%s %ld\nextern unsigned char binary_%s[%ld];\n", name, size, name, len);
-            fprintf(c, "unsigned char binary_%s[%ld] = { ", name, len);
+            fprintf(h, "#define sizeof_%s %ld\nextern const unsigned char binary_%s[%ld];\n", name, size, name, len);
+            fprintf(c, "const unsigned char binary_%s[%ld] = { ", name, len);
             for(i = 0; i < len; i++)
                 fprintf(c,"%s%d", i?",":"", buff[i]);
             fprintf(c," };\n");
@@ -37,26 +37,66 @@ void cpio_open(gpt_t *gpt_entry)
 
 void cpio_add(struct stat *st, char *name, unsigned char *content, int size)
 {
-    unsigned char *end;
+    unsigned char hdr[MAXPATH + 96];
     int n = strlen(name);
     if(!S_ISREG(st->st_mode) && !S_ISDIR(st->st_mode) && !S_ISLNK(st->st_mode)) return;
-    fs_base = realloc(fs_base, fs_len + 76 + n + 1 + size);
-    if(!fs_base) { fprintf(stderr,"mkbootimg: %s\r\n", lang[ERR_MEM]); exit(1); }
-    end = fs_base + fs_len;
-    end += sprintf((char*)end, "070707000000000000%06o00000000000000000000000000000000000%06o%011o%s",
+    sprintf((char*)hdr, "070707000000000000%06o00000000000000000000000000000000000%06o%011o%s",
         st->st_mode & 0777777,n+1,size,name);
-    *end++ = 0;
-    if(content && size) memcpy(end, content, size);
-    fs_len += 76 + n + 1 + size;
+    fs_emit(hdr, 76 + n + 1);
+    if(content && size) fs_emit(content, size);
+}
+
+void cpio_addbegin(struct stat *st, char *name)
+{
+    unsigned char hdr[MAXPATH + 96];
+    int n = strlen(name);
+    sprintf((char*)hdr, "070707000000000000%06o00000000000000000000000000000000000%06o%011o%s",
+        st->st_mode & 0777777,n+1,(int)st->st_size,name);
+    fs_emit(hdr, 76 + n + 1);
+}
+
+void cpio_addchunk(unsigned char *chunk, int size)
+{
+    fs_emit(chunk, size);
+}
+
+void cpio_addend()
+{
+}
+
+void cpio_addlink(struct stat *st, char *name, char *target, long int toffs)
+{
+    unsigned char hdr[MAXPATH + 96], old[6];
+    char tmp[8];
+    static int lastino = 0;
+    int i, ino = 0, nlink = 0, n = strlen(name);
+    (void)target;
+    /* entries are normally written with a zero inode, the first copy gets a
+     * unique one when it turns out to be the head of a link group */
+    fs_fetch(toffs + 12, old, 6);
+    for(i = 0; i < 6; i++) ino = (ino << 3) + (old[i] - '0');
+    if(!ino) {
+        ino = ++lastino;
+        sprintf(tmp, "%06o", ino & 0777777);
+        fs_patch(toffs + 12, (unsigned char*)tmp, 6);
+    }
+    fs_fetch(toffs + 36, old, 6);
+    for(i = 0; i < 6; i++) nlink = (nlink << 3) + (old[i] - '0');
+    if(nlink < 1) nlink = 1;
+    nlink++;
+    sprintf(tmp, "%06o", nlink & 0777777);
+    fs_patch(toffs + 36, (unsigned char*)tmp, 6);
+    /* the data travels with the first entry only, further links are zero sized */
+    sprintf((char*)hdr, "070707000000%06o%06o000000000000%06o000000%011o%06o%011o%s",
+        ino & 0777777, st->st_mode & 0777777, nlink & 0777777, 0, n+1, 0, name);
+    fs_emit(hdr, 76 + n + 1);
 }
 
 void cpio_close()
 {
-    char *end;
-    fs_base = realloc(fs_base, fs_len + 76 + 11 + 512);
-    if(!fs_base) { fprintf(stderr,"mkbootimg: %s\r\n", lang[ERR_MEM]); exit(1); }
-    end = (char*)fs_base + fs_len;
-    memset(end, 0, 76 + 11 + 512);
-    end += sprintf(end, "07070700000000000000000000000000000000000010000000000000000%06o%011oTRAILER!!!",11,0);
-    fs_len = ((fs_len + 88 + 511) & ~511);
+    char end[128];
+    int target = ((fs_len + 88 + 511) & ~511), n;
+    n = sprintf(end, "07070700000000000000000000000000000000000010000000000000000%06o%011oTRAILER!!!",11,0);
+    fs_emit((unsigned char*)end, n);
+    fs_emitzero(target - fs_len);
 }
@@ -137,8 +137,7 @@ void ech_close()
     }
     offs = 16 + ((ech_maxents * sizeof(ech_entry_t) + 511) / 512) + (ech_numblk * 8 + 511) / 512;
     fs_len = ech_numblk*512;
-    fs_base = realloc(fs_base, fs_len);
-    if(!fs_base) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
+    fs_reserve(fs_len);
     memset(fs_base, 0, fs_len);
     /* superblock */
     memcpy(fs_base + 4, "_ECH_FS_", 8);
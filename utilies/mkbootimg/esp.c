@@ -100,9 +100,11 @@ unsigned char *esp_addfile(unsigned char *ptr, char *name, unsigned char *conten
 }
 
 /**
- * Add a compressed file to the boot partition
+ * Add a compressed file to the boot partition. The embedded loader blobs stay
+ * deflated in the read-only data segment, so only the ones actually needed
+ * for the target platforms are ever inflated (and paged in)
  */
-unsigned char *esp_addzfile(unsigned char *ptr, char *name, unsigned char *content, int size, unsigned long int len)
+unsigned char *esp_addzfile(unsigned char *ptr, char *name, const unsigned char *content, int size, unsigned long int len)
 {
     unsigned char *buf = malloc(len);
     if(!buf) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
@@ -112,14 +114,60 @@ unsigned char *esp_addzfile(unsigned char *ptr, char *name, unsigned char *conte
     return ptr;
 }
 
+/**
+ * Pre-scan sizing pass: compute exactly how much room the partition contents
+ * will take before anything is allocated. Returns the smallest size in
+ * megabytes where the reserved sectors, both FAT copies, the root directory
+ * and every file (at cluster granularity) fit, so esp_makepart() can allocate
+ * once and no hand-tuned oversized boot_size is needed
+ */
+static int esp_presize(int boot)
+{
+    unsigned long int len[12], bytes, need, bpc2, spf2;
+    int i, n = 0, m, f32;
+
+    len[n++] = strlen(config);
+    if(!initrd_arch[1]) len[n++] = initrd_size[0];
+    else for(i = 0; i < NUMARCH && initrd_arch[i]; i++) len[n++] = initrd_size[i];
+    if(boot & (1 << 2)) len[n++] = sizeof_bootboot_rv64;
+    if(boot & (1 << 1)) { len[n++] = sizeof_bootboot_bin; len[n++] = sizeof_bootboot_efi; }
+    if(boot & (1 << 0)) {
+        len[n++] = sizeof_bootboot_img; len[n++] = sizeof_bootcode_bin;
+        len[n++] = sizeof_fixup_dat; len[n++] = sizeof_start_elf;
+        len[n++] = sizeof_LICENCE_broadcom;
+    }
+    for(m = boot_size < 8 ? 8 : boot_size; ; m++) {
+        /* the same FAT type and cluster size rules esp_makepart() applies */
+        f32 = boot_fat == 32 || m >= 128;
+        if(f32 && m < (iso9660 ? 128 : 33)) m = iso9660 ? 128 : 33;
+        bpc2 = (f32 && !iso9660 && m < 128 ? 1 : 4) * 512;
+        /* data clusters: numbering starts at 3, one cluster for the BOOTBOOT
+         * directory and two more for EFI/BOOT with the UEFI loader */
+        bytes = (3 + 1 + ((boot & (1 << 1)) ? 2 : 0)) * bpc2;
+        for(i = 0; i < n; i++) bytes += (len[i] + bpc2 - 1) & ~(bpc2 - 1);
+        if(f32) {
+            spf2 = ((1024UL*1024*m/bpc2)*4)/512 - 8;
+            need = (2*spf2 + 8)*512 - 2*bpc2 + bytes;   /* data area starts two clusters below the root dir */
+        } else {
+            spf2 = ((1024UL*1024*m/bpc2)*2 + 511)/512;
+            need = (2*spf2 + 4)*512 + ((512*32 - 4096) & ~2047UL) + bytes;
+        }
+        if(need <= 1024UL*1024*m) return m;
+    }
+}
+
 /**
  * Create EFI System Partition with FAT16 or FAT32
  */
 void esp_makepart()
 {
     unsigned char *rootdir, *ptr;
-    int i = (initrd_size[0] + 2047 + initrd_size[1] + 2047 + 1024*1024-1)/1024/1024 + 3, spf, boot = 0;
+    int i, spf, boot = 0;
 
+    nextcluster = 3; lastcluster = 0; esp_bbs = 0;
+    for(i = 0; i < NUMARCH && initrd_arch[i]; i++)
+        boot |= (1 << (initrd_arch[i] - 1));
+    i = esp_presize(boot);
     if(boot_size < i) boot_size = i;
     /* we must force 16M at least, because if FAT16 has too few clusters, some UEFI thinks it's FAT12... */
     if(boot_size < 8) boot_size = 8;
@@ -173,9 +221,6 @@ void esp_makepart()
     /* label in root directory */
     rootdir = esp_adddirent(rootdir, ".", 8, 0, 0);
     memcpy(rootdir - 32, "EFI System ", 11);
-    /* add contents */
-    for(i = 0; i < NUMARCH && initrd_arch[i]; i++)
-        boot |= (1 << (initrd_arch[i] - 1));
 
     /* add loader's directory with config and initrds */
     ptr = esp_mkdir(rootdir, "BOOTBOOT", 0); rootdir += 32;
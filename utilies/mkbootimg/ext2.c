@@ -248,8 +248,7 @@ void ext_open(gpt_t *gpt_entry)
     ext_numblk = (gpt_entry->last - gpt_entry->start + 1) * 512 / SECSIZE;
     if(ext_numblk < 8) { fprintf(stderr,"mkbootimg: partition #%d %s\r\n", fs_no, lang[ERR_NOSIZE]); exit(1); }
     fs_len = ext_numblk * SECSIZE;
-    fs_base = realloc(fs_base, fs_len);
-    if(!fs_base) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
+    fs_reserve(fs_len);
     memset(fs_base, 0, fs_len);
     ext_nextinode = ext_nextblk = 0;
     ext_numbg = ext_numblk / (SECSIZE<<3);
@@ -48,8 +48,7 @@ int fsz_add_inode(char *filetype, char *mimetype)
         fprintf(stderr,"mkbootimg: partition #%d %s\n", fs_no, lang[ERR_TOOBIG]);
         exit(1);
     }
-    fs_base=realloc(fs_base,fs_len+fsz_secsize);
-    if(!fs_base) { fprintf(stderr,"mkbootimg: %s\r\n", lang[ERR_MEM]); exit(1); }
+    fs_reserve(fs_len+fsz_secsize);
     memset(fs_base+fs_len,0,fsz_secsize);
     in=(FSZ_Inode *)(fs_base+fs_len);
     memcpy(in->magic,FSZ_IN_MAGIC,4);
@@ -138,9 +137,8 @@ void fsz_add_file(char *name, unsigned char *data, unsigned long int size)
         fprintf(stderr,"mkbootimg: partition #%d %s: %s\n", fs_no, lang[ERR_TOOBIG], name);
         exit(1);
     }
-    fs_base=realloc(fs_base,fs_len+fsz_secsize+s);
-    if(!fs_base) { fprintf(stderr,"mkbootimg: %s\r\n", lang[ERR_MEM]); exit(1); }
-    memset(fs_base+fs_len,0,fsz_secsize);
+    fs_reserve(fs_len+fsz_secsize+s);
+    memset(fs_base+fs_len,0,fsz_secsize+s);
     in=(FSZ_Inode *)(fs_base+inode*fsz_secsize);
     in->changedate=t * 1000000;
     in->modifydate=t * 1000000;
@@ -286,8 +284,7 @@ void fsz_add_file(char *name, unsigned char *data, unsigned long int size)
 void fsz_open(gpt_t *gpt_entry)
 {
     FSZ_SuperBlock *sb;
-    fs_base = realloc(fs_base, 2*fsz_secsize);
-    if(!fs_base) { fprintf(stderr,"mkbootimg: %s\r\n", lang[ERR_MEM]); exit(1); }
+    fs_reserve(2*fsz_secsize);
     memset(fs_base,0,2*fsz_secsize);
     sb=(FSZ_SuperBlock *)(fs_base);
     memcpy(sb->magic,FSZ_MAGIC,4);
@@ -0,0 +1,184 @@
+/*
+ * mkbootimg/geninitrd.c
+ *
+ * Copyright (C) 2017 - 2021 bzt (bztsrc@gitlab)
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * This file is part of the BOOTBOOT Protocol package.
+ * @brief Synthetic initrd tree generator for the benchmark harness
+ *
+ * Creates a deterministic directory tree with a parameterized file count,
+ * size distribution and duplicate ratio, plus a minimal valid kernel ELF
+ * at sys/core, so that the full mkbootimg pipeline can be timed on
+ * reproducible input. See bench.sh
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef __WIN32__
+#define makedir(x) mkdir(x)
+#else
+#define makedir(x) mkdir(x, 0755)
+#endif
+
+/* how many files go into one subdirectory */
+#define PERDIR 256
+
+static unsigned int state;
+
+/* xorshift, so the same seed always produces the same tree */
+static unsigned int rnd()
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/**
+ * Write one file of the given size, its content derived from its own seed.
+ * Re-running with the same seed and size gives a byte-identical file, which
+ * is how duplicates are made
+ */
+static void genfile(char *path, unsigned int seed, long int size)
+{
+    unsigned char buf[65536];
+    unsigned int s = seed;
+    long int i, n;
+    FILE *f;
+
+    f = fopen(path, "wb");
+    if(!f) { fprintf(stderr, "geninitrd: unable to write '%s'\r\n", path); exit(1); }
+    while(size > 0) {
+        n = size > (long int)sizeof(buf) ? (long int)sizeof(buf) : size;
+        for(i = 0; i < n; i++) {
+            s ^= s << 13; s ^= s >> 17; s ^= s << 5;
+            buf[i] = (unsigned char)s;
+        }
+        fwrite(buf, n, 1, f);
+        size -= n;
+    }
+    fclose(f);
+}
+
+/**
+ * Write a minimal but valid x86_64 kernel ELF: one PT_LOAD segment at the
+ * BOOTBOOT core virtual address, entry point at the segment start
+ */
+static void genkernel(char *path)
+{
+    unsigned char elf[4096 + 256];
+    uint64_t vaddr = 0xffffffffffe02000UL;
+    FILE *f;
+
+    memset(elf, 0, sizeof(elf));
+    memcpy(elf, "\177ELF", 4);
+    elf[4] = 2;                                     /* EI_CLASS: 64 bit */
+    elf[5] = 1;                                     /* EI_DATA: little endian */
+    elf[6] = 1;                                     /* EI_VERSION */
+    elf[16] = 2;                                    /* e_type: executable */
+    elf[18] = 62;                                   /* e_machine: EM_X86_64 */
+    elf[20] = 1;                                    /* e_version */
+    memcpy(elf + 24, &vaddr, 8);                    /* e_entry */
+    elf[32] = 64;                                   /* e_phoff */
+    elf[52] = 64;                                   /* e_ehsize */
+    elf[54] = 56;                                   /* e_phentsize */
+    elf[56] = 1;                                    /* e_phnum */
+    elf[64] = 1;                                    /* p_type: PT_LOAD */
+    elf[68] = 7;                                    /* p_flags: rwx */
+    elf[73] = 0x10;                                 /* p_offset: 4096 */
+    memcpy(elf + 80, &vaddr, 8);                    /* p_vaddr */
+    memcpy(elf + 88, &vaddr, 8);                    /* p_paddr */
+    elf[97] = 1;                                    /* p_filesz: 256 */
+    elf[105] = 0x10;                                /* p_memsz: 4096 */
+    elf[4096] = 0xEB; elf[4097] = 0xFE;             /* jmp $ */
+
+    f = fopen(path, "wb");
+    if(!f) { fprintf(stderr, "geninitrd: unable to write '%s'\r\n", path); exit(1); }
+    fwrite(elf, sizeof(elf), 1, f);
+    fclose(f);
+}
+
+/**
+ * Usage: geninitrd <directory> <numfiles> <avgsize> <duppercent> [seed]
+ */
+int main(int argc, char **argv)
+{
+    char path[1100], dir[1024];
+    unsigned int *seeds;
+    long int *sizes, total = 0;
+    int numfiles, avgsize, dup, i, d = -1;
+
+    if(argc < 5) {
+        printf("BOOTBOOT mkbootimg synthetic initrd generator\r\n\r\n");
+        printf("./geninitrd <directory> <numfiles> <avgsize> <duppercent> [seed]\r\n");
+        return 1;
+    }
+    numfiles = atoi(argv[2]);
+    avgsize = atoi(argv[3]);
+    dup = atoi(argv[4]);
+    state = argc > 5 ? (unsigned int)atoi(argv[5]) : 0x1234ABCD;
+    if(numfiles < 1 || avgsize < 1 || dup < 0 || dup > 99 || !state) {
+        fprintf(stderr, "geninitrd: bad arguments\r\n"); return 1;
+    }
+    seeds = (unsigned int*)malloc(numfiles * sizeof(unsigned int));
+    sizes = (long int*)malloc(numfiles * sizeof(long int));
+    if(!seeds || !sizes) { fprintf(stderr, "geninitrd: unable to allocate memory\r\n"); return 1; }
+
+    makedir(argv[1]);
+    sprintf(path, "%s/sys", argv[1]);
+    makedir(path);
+    sprintf(path, "%s/sys/core", argv[1]);
+    genkernel(path);
+
+    for(i = 0; i < numfiles; i++) {
+        if(i / PERDIR != d) {
+            d = i / PERDIR;
+            sprintf(dir, "%s/d%03d", argv[1], d);
+            makedir(dir);
+        }
+        if(i > 0 && (int)(rnd() % 100) < dup) {
+            /* duplicate: same seed and size as an earlier file gives the
+             * same bytes, so content level dedup can find it */
+            int j = rnd() % i;
+            seeds[i] = seeds[j];
+            sizes[i] = sizes[j];
+        } else {
+            seeds[i] = rnd();
+            /* mostly around the average with a long tail: every 32nd file
+             * is an order of magnitude bigger */
+            sizes[i] = avgsize / 8 + (long int)(rnd() % (unsigned int)avgsize);
+            if(!(i & 31)) sizes[i] *= 10;
+        }
+        sprintf(path, "%s/f%05d.bin", dir, i);
+        genfile(path, seeds[i], sizes[i]);
+        total += sizes[i];
+    }
+    printf("geninitrd: %d files, %ld bytes in '%s'\r\n", numfiles, total, argv[1]);
+    free(seeds);
+    free(sizes);
+    return 0;
+}
@@ -28,6 +28,117 @@
  *
  */
 #include "main.h"
+#ifndef __WIN32__
+#include <pthread.h>
+#endif
+
+/**
+ * an empty block for cheap zero detection
+ */
+static unsigned char img_zero[4096];
+
+#ifndef __WIN32__
+#define IMG_PIPESLOTS 4
+
+/**
+ * bounded queue between the partition file reader thread and the image
+ * writer, so reading the next blocks overlaps writing the current ones
+ */
+typedef struct {
+    FILE *f;
+    unsigned char *buf[IMG_PIPESLOTS];
+    size_t len[IMG_PIPESLOTS];
+    int nread, nwritten;
+    pthread_mutex_t lock;
+    pthread_cond_t filled, drained;
+} imgpipe_t;
+
+static void *img_readworker(void *data)
+{
+    imgpipe_t *p = (imgpipe_t*)data;
+    size_t s;
+    int slot;
+    do {
+        pthread_mutex_lock(&p->lock);
+        while(p->nread - p->nwritten == IMG_PIPESLOTS) pthread_cond_wait(&p->drained, &p->lock);
+        pthread_mutex_unlock(&p->lock);
+        slot = p->nread % IMG_PIPESLOTS;
+        s = p->len[slot] = fread(p->buf[slot], 1, 1024*1024, p->f);
+        pthread_mutex_lock(&p->lock);
+        p->nread++;
+        pthread_cond_signal(&p->filled);
+        pthread_mutex_unlock(&p->lock);
+    } while(s);
+    return NULL;
+}
+#endif
+
+/**
+ * Checksums of the data written into each partition region, for --verify
+ */
+static uint32_t img_crc[250];
+static unsigned long int img_crclen[250];
+
+/**
+ * One partition region of the re-read pass
+ */
+typedef struct {
+    char *fn;
+    unsigned long int offs, len;
+    uint32_t crc;
+    int err;
+    int thr;                    /* got its own thread, needs a join */
+} imgvrfy_t;
+
+/**
+ * Re-read one region and recompute its checksum. Every region gets its own
+ * file handle so the readers don't serialize on a shared position
+ */
+static void img_verifyregion(imgvrfy_t *v)
+{
+    FILE *f;
+    unsigned char *buf;
+    unsigned long int left = v->len;
+    size_t n;
+    v->crc = 0; v->err = 0;
+    if(!(f = fopen(v->fn, "rb"))) { v->err = 1; return; }
+    if(!(buf = malloc(1024*1024))) { fclose(f); v->err = 1; return; }
+    fseek(f, v->offs, SEEK_SET);
+    while(left) {
+        n = fread(buf, 1, left > 1024*1024 ? 1024*1024 : left, f);
+        if(!n) { v->err = 1; break; }
+        v->crc = crc32_cont(v->crc, buf, (int)n);
+        left -= n;
+    }
+    free(buf);
+    fclose(f);
+}
+
+#ifndef __WIN32__
+static void *img_verifyworker(void *data)
+{
+    img_verifyregion((imgvrfy_t*)data);
+    return NULL;
+}
+#endif
+
+/**
+ * Write out a buffer, but seek over the all-zero blocks so that the OS can
+ * leave holes in the image file. Skipped ranges read back as zeros because
+ * the target was opened with "wb", and the backup GPT written at the very
+ * end always extends the file to its full size
+ */
+static void img_sparsewrite(FILE *f, unsigned char *buf, size_t len)
+{
+    size_t o, n;
+    for(o = 0; o < len; o += n) {
+        n = len - o > sizeof(img_zero) ? sizeof(img_zero) : len - o;
+        if(n == sizeof(img_zero) && !memcmp(buf + o, img_zero, sizeof(img_zero)))
+            fseek(f, n, SEEK_CUR);
+        else
+            fwrite(buf + o, 1, n, f);
+    }
+}
 
 /**
  * Assemble and write out disk image
@@ -35,54 +146,108 @@
 void img_write(char *fn)
 {
     FILE *f, *d;
-    int i, j, n, lastpercent, k;
+    int i, j, n, lastpercent, k, piped;
     char key[64], *tmp, *dir, *buf;
     unsigned long int size, pos;
+    uint32_t wcrc;
     size_t s;
     time_t c = 0;
+#ifndef __WIN32__
+    imgpipe_t pl;
+    pthread_t rt;
+    int slot;
+#endif
 
     buf = malloc(1024*1024);
     if(!buf) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(2); }
+    memset(img_crc, 0, sizeof(img_crc)); memset(img_crclen, 0, sizeof(img_crclen));
 
-    f=fopen(fn,"wb");
+    /* "wb+" because streamed partitions read back earlier headers to patch them */
+    f=fopen(fn,"wb+");
     if(!f) { fprintf(stderr,"mkbootimg: %s %s\n", lang[ERR_WRITE],fn); exit(3); }
     /* write out primary GPT table (and optional ISO9660 header) */
     fwrite(gpt,es*512,1,f);
     /* write out ESP */
-    fwrite(esp,esp_size,1,f);
+    img_sparsewrite(f,esp,esp_size);
+    if(verify) { img_crc[0] = crc32_calc(esp, esp_size); img_crclen[0] = esp_size; }
     fseek(f,(es+esiz)*512,SEEK_SET);
     /* write out other partitions */
     for(k = 1; k < np; k++) {
-        size = 0;
+        size = 0; wcrc = 0;
         sprintf(key, "partitions.%d.%s", k, "file");
         tmp = json_get(json, key);
         if(tmp && *tmp) {
             d = fopen(tmp, "rb");
             free(tmp);
             if(d) {
-                while((s = fread(buf, 1, 1024*1024, d)) != 0) {
-                    fwrite(buf, 1, s, f);
-                    size += s;
-                    if(c > t + 1) {
-                        pos = ftell(f);
-                        n = pos * 100L / (tsize + 1);
-                        if(n != lastpercent) {
-                            lastpercent = n;
-                            printf("\rmkbootimg: %s [",lang[WRITING]);
-                            for(i = 0; i < 20; i++) printf(i < n/5 ? "#" : " ");
-                            printf("] %3d%% ", n);
-                            fflush(stdout);
+                piped = 0;
+#ifndef __WIN32__
+                /* pipelined copy: a worker thread reads ahead while we write */
+                memset(&pl, 0, sizeof(pl));
+                pl.f = d;
+                for(j = 0; j < IMG_PIPESLOTS; j++) if(!(pl.buf[j] = malloc(1024*1024))) break;
+                if(j == IMG_PIPESLOTS && !pthread_mutex_init(&pl.lock, NULL) &&
+                   !pthread_cond_init(&pl.filled, NULL) && !pthread_cond_init(&pl.drained, NULL) &&
+                   !pthread_create(&rt, NULL, img_readworker, &pl)) {
+                    while(1) {
+                        pthread_mutex_lock(&pl.lock);
+                        while(pl.nread == pl.nwritten) pthread_cond_wait(&pl.filled, &pl.lock);
+                        pthread_mutex_unlock(&pl.lock);
+                        slot = pl.nwritten % IMG_PIPESLOTS;
+                        s = pl.len[slot];
+                        if(s) {
+                            img_sparsewrite(f, pl.buf[slot], s); size += s;
+                            if(verify) wcrc = crc32_cont(wcrc, pl.buf[slot], s);
                         }
-                    } else
-                        time(&c);
+                        pthread_mutex_lock(&pl.lock);
+                        pl.nwritten++;
+                        pthread_cond_signal(&pl.drained);
+                        pthread_mutex_unlock(&pl.lock);
+                        if(!s) break;
+                        if(c > t + 1) {
+                            pos = ftell(f);
+                            n = pos * 100L / (tsize + 1);
+                            if(n != lastpercent) {
+                                lastpercent = n;
+                                printf("\rmkbootimg: %s [",lang[WRITING]);
+                                for(i = 0; i < 20; i++) printf(i < n/5 ? "#" : " ");
+                                printf("] %3d%% ", n);
+                                fflush(stdout);
+                            }
+                        } else
+                            time(&c);
+                    }
+                    pthread_join(rt, NULL);
+                    piped = 1;
                 }
+                for(j = 0; j < IMG_PIPESLOTS; j++) free(pl.buf[j]);
+#endif
+                if(!piped)
+                    while((s = fread(buf, 1, 1024*1024, d)) != 0) {
+                        img_sparsewrite(f, (unsigned char*)buf, s);
+                        size += s;
+                        if(verify) wcrc = crc32_cont(wcrc, (unsigned char*)buf, s);
+                        if(c > t + 1) {
+                            pos = ftell(f);
+                            n = pos * 100L / (tsize + 1);
+                            if(n != lastpercent) {
+                                lastpercent = n;
+                                printf("\rmkbootimg: %s [",lang[WRITING]);
+                                for(i = 0; i < 20; i++) printf(i < n/5 ? "#" : " ");
+                                printf("] %3d%% ", n);
+                                fflush(stdout);
+                            }
+                        } else
+                            time(&c);
+                    }
                 fclose(d);
+                if(verify) { img_crc[k] = wcrc; img_crclen[k] = size; }
             }
         } else {
             sprintf(key, "partitions.%d.%s", k, "directory");
             dir = json_get(json, key);
             if(dir && *dir) {
-                fs_base = NULL; fs_len = 0; fs_no = k + 1;
+                fs_base = NULL; fs_len = fs_cap = 0; fs_no = k + 1;
                 sprintf(key, "partitions.%d.%s", k, "driver");
                 tmp = json_get(json, key);
                 if(!tmp || !*tmp) {
@@ -91,14 +256,26 @@ void img_write(char *fn)
                 }
                 if(tmp && *tmp) {
                     rd_open = NULL; rd_add = NULL; rd_close = NULL;
+                    rd_addbegin = NULL; rd_addchunk = NULL; rd_addend = NULL; rd_addlink = NULL;
                     for(i = 0; fsdrv[i].name && fsdrv[i].add; i++)
-                        if(!strcmp(tmp, fsdrv[i].name)) { rd_open = fsdrv[i].open; rd_add = fsdrv[i].add; rd_close = fsdrv[i].close; break; }
+                        if(!strcmp(tmp, fsdrv[i].name)) {
+                            rd_open = fsdrv[i].open; rd_add = fsdrv[i].add; rd_close = fsdrv[i].close;
+                            rd_addbegin = fsdrv[i].add_begin; rd_addchunk = fsdrv[i].add_chunk; rd_addend = fsdrv[i].add_end;
+                            rd_addlink = fsdrv[i].add_link;
+                            break;
+                        }
                     free(tmp);
                     if(rd_add) {
                         skipbytes = strlen(dir) + 1;
+                        profile_mark();
+                        /* append-only formats stream directly into the image file,
+                         * skipping the partition-sized buffer and the extra copy */
+                        if(rd_addbegin) { fs_out = f; fs_out_offs = ftell(f); }
                         if(rd_open) (*rd_open)((gpt_t*)(gpt + 1024 + k * 128));
                         parsedir(dir, 0);
                         if(rd_close) (*rd_close)();
+                        sprintf(key, "parsedir.part%d", k);
+                        profile_stage(key, fs_len);
                     } else {
                         fprintf(stderr,"mkbootimg: partition #%d %s. %s:\r\n", np+1, lang[ERR_TYPE], lang[ERR_ACCEPTVALUES]);
                         for(i = 0; fsdrv[i].name; i++)
@@ -112,12 +289,40 @@ void img_write(char *fn)
                     }
                 }
                 free(dir);
-                if(fs_base && fs_len) {
+                if(fs_out) {
+                    /* already in the file, only the bookkeeping is left */
+                    fs_out = NULL;
+                    if(gpt_parts[k] < (unsigned long int)fs_len) {
+                        fprintf(stderr,"mkbootimg: partition #%d %s.\r\n", k+1,lang[ERR_PARTSIZE]);
+                        exit(2);
+                    }
+                    if(verify) {
+                        /* re-read the streamed range (still in the page cache); a plain
+                         * running checksum wouldn't survive the hard link backpatches.
+                         * Holes past EOF read short, they count as zeros */
+                        fflush(f);
+                        fseek(f, fs_out_offs, SEEK_SET);
+                        wcrc = 0;
+                        for(pos = 0; pos < (unsigned long int)fs_len; pos += s) {
+                            s = fread(buf, 1, (unsigned long int)fs_len - pos > 1024*1024 ? 1024*1024 : (unsigned long int)fs_len - pos, f);
+                            if(!s) break;
+                            wcrc = crc32_cont(wcrc, (unsigned char*)buf, s);
+                        }
+                        for(; pos < (unsigned long int)fs_len; pos += s) {
+                            s = (unsigned long int)fs_len - pos > sizeof(img_zero) ? sizeof(img_zero) : (unsigned long int)fs_len - pos;
+                            wcrc = crc32_cont(wcrc, img_zero, s);
+                        }
+                        img_crc[k] = wcrc; img_crclen[k] = fs_len;
+                    }
+                    fseek(f, fs_out_offs + fs_len, SEEK_SET);
+                    size += fs_len;
+                } else if(fs_base && fs_len) {
                     if(gpt_parts[k] < (unsigned long int)fs_len) {
                         fprintf(stderr,"mkbootimg: partition #%d %s.\r\n", k+1,lang[ERR_PARTSIZE]);
                         exit(2);
                     }
-                    fwrite(fs_base, fs_len, 1, f);
+                    img_sparsewrite(f, fs_base, fs_len);
+                    if(verify) { img_crc[k] = crc32_calc(fs_base, fs_len); img_crclen[k] = fs_len; }
                     free(fs_base);
                     size += fs_len;
                 }
@@ -134,3 +339,76 @@ void img_write(char *fn)
     printf("mkbootimg: %s %s.\r\n", fn, lang[SAVED]);
     free(buf);
 }
+
+/**
+ * Re-read the finished image and check it, one reader per partition region.
+ * The data is still in the page cache, so this is much cheaper than an
+ * external checksum pass, yet catches the same flaky disk corruptions
+ */
+void img_verify(char *fn)
+{
+    FILE *f;
+    unsigned char hdr[512], *ptab;
+    imgvrfy_t v[250];
+    unsigned long int o;
+    uint64_t plba;
+    uint32_t hsz, hcrc, pnum, psz, pcrc;
+    int k, err = 0;
+#ifndef __WIN32__
+    pthread_t th[250];
+#endif
+
+    if(!(f = fopen(fn, "rb"))) { fprintf(stderr,"mkbootimg: %s %s\r\n", lang[ERR_WRITE], fn); exit(3); }
+    /* check the GPT checksums exactly like a firmware would */
+    fseek(f, 512, SEEK_SET);
+    if(fread(hdr, 512, 1, f) != 1 || memcmp(hdr, "EFI PART", 8)) err = 1;
+    else {
+        memcpy(&hsz, hdr + 12, 4); memcpy(&hcrc, hdr + 16, 4);
+        memcpy(&plba, hdr + 72, 8); memcpy(&pnum, hdr + 80, 4);
+        memcpy(&psz, hdr + 84, 4); memcpy(&pcrc, hdr + 88, 4);
+        memset(hdr + 16, 0, 4);
+        if(hsz < 92 || hsz > 512 || crc32(0, hdr, hsz) != hcrc) err = 1;
+        ptab = malloc(pnum * psz);
+        if(ptab) {
+            fseek(f, plba * 512, SEEK_SET);
+            if(fread(ptab, pnum * psz, 1, f) != 1 || crc32(0, ptab, pnum * psz) != pcrc) err = 1;
+            free(ptab);
+        }
+        /* backup header at the last LBA */
+        fseek(f, tsize - 512, SEEK_SET);
+        if(fread(hdr, 512, 1, f) != 1 || memcmp(hdr, "EFI PART", 8)) err = 1;
+        else {
+            memcpy(&hsz, hdr + 12, 4); memcpy(&hcrc, hdr + 16, 4);
+            memset(hdr + 16, 0, 4);
+            if(hsz < 92 || hsz > 512 || crc32(0, hdr, hsz) != hcrc) err = 1;
+        }
+    }
+    fclose(f);
+    if(err) { fprintf(stderr,"mkbootimg: %s GPT verification failed\r\n", fn); exit(2); }
+
+    /* partition regions, offsets recomputed from the same table the writer used */
+    memset(v, 0, sizeof(v));
+    v[0].offs = es * 512;
+    o = (es + esiz) * 512;
+    for(k = 1; k < np; k++) { v[k].offs = o; o += gpt_parts[k]; }
+    for(k = 0; k < np; k++) { v[k].fn = fn; v[k].len = img_crclen[k]; }
+#ifndef __WIN32__
+    for(k = 0; k < np; k++)
+        if(v[k].len) {
+            v[k].thr = !pthread_create(&th[k], NULL, img_verifyworker, &v[k]);
+            if(!v[k].thr) img_verifyregion(&v[k]);
+        }
+    for(k = 0; k < np; k++)
+        if(v[k].thr) pthread_join(th[k], NULL);
+#else
+    for(k = 0; k < np; k++)
+        if(v[k].len) img_verifyregion(&v[k]);
+#endif
+    for(k = 0; k < np; k++)
+        if(v[k].len && (v[k].err || v[k].crc != img_crc[k])) {
+            fprintf(stderr,"mkbootimg: partition #%d verification failed\r\n", k + 1);
+            err = 1;
+        }
+    if(err) exit(2);
+    printf("mkbootimg: %s verified.\r\n", fn);
+}
@@ -34,8 +34,7 @@ void jamesm_open(gpt_t *gpt_entry)
 {
     if(gpt_entry) { fprintf(stderr,"mkbootimg: partition #%d %s jamesm.\r\n", fs_no, lang[ERR_INITRDTYPE]); exit(1); }
     fs_len = 4 + 64 * 73;
-    fs_base = realloc(fs_base, fs_len);
-    if(!fs_base) { fprintf(stderr,"mkbootimg: %s\r\n", lang[ERR_MEM]); exit(1); }
+    fs_reserve(fs_len);
     memset(fs_base, 0, fs_len);
 }
 
@@ -43,8 +42,7 @@ void jamesm_add(struct stat *st, char *name, unsigned char *content, int size)
 {
     unsigned char *end;
     if(!S_ISREG(st->st_mode) || !content || !size) return;
-    fs_base = realloc(fs_base, fs_len + size);
-    if(!fs_base) { fprintf(stderr,"mkbootimg: %s\r\n", lang[ERR_MEM]); exit(1); }
+    fs_reserve(fs_len + size);
     /* this format is specified to hold maximum 64 files... */
     if(fs_base[0] > 63) { fprintf(stderr,"mkbootimg: %s\r\n", lang[ERR_TOOMANY]); exit(1); }
     end = fs_base + fs_len;
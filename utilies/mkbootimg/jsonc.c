@@ -27,17 +27,135 @@
  * @brief Memory allocation-free, extremely fast JSON parser in pure ANSI C
  *
  */
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #define JSON_MAXPATHLEVEL 32
 
+void json_discard();
+
+/* parse-once index: the document is tokenized a single time and every leaf is
+ * recorded as a dotted path plus value in a flat sorted table, so lookups are
+ * a bsearch instead of a full rescan of the document per key */
+typedef struct {
+    long key;               /* arena offsets, converted to pointers when sorting */
+    long val;               /* -1 for JSON null */
+} json_idx_t;
+
+static const char *json_src = NULL; /* document the current index was built from */
+static json_idx_t *json_idx = NULL;
+static char *json_arena = NULL;
+static int json_num = 0;
+
+static int json_idxcmp(const void *a, const void *b)
+{
+    return strcmp(json_arena + ((const json_idx_t*)a)->key, json_arena + ((const json_idx_t*)b)->key);
+}
+
+static int json_findcmp(const void *a, const void *b)
+{
+    return strcmp((const char*)a, json_arena + ((const json_idx_t*)b)->key);
+}
+
+/**
+ * Tokenize the document once and build the leaf index. Array elements are
+ * indexed by position, object fields by name, the same canonical paths the
+ * callers use. Returns 0 on out of memory (the caller falls back to scanning)
+ */
+static int json_index(const char *jsonstr)
+{
+    unsigned char *c=(unsigned char*)jsonstr,*k[JSON_MAXPATHLEVEL+1];
+    unsigned char *v,*s,*e;
+    long o=0, need, acap, icap=64;
+    int l=0, j=1, i, n, x[JSON_MAXPATHLEVEL+1]={0};
+    json_discard();
+    acap = strlen(jsonstr) + 256;
+    json_arena = malloc(acap);
+    json_idx = malloc(icap * sizeof(json_idx_t));
+    if(!json_arena || !json_idx) return 0;
+    while(1) {
+        while(*c && *c<=' ') c++;
+        if(j) { j=0; k[l]=v=c; }
+        switch(*c) {
+        case '\"': c++; while(*c && *c!='\"'){if(*c=='\\'){c++;} c++;} break;
+        case ':': c++; while(*c && *c<=' ') { c++; } v=c--; break;
+        case 0: case ',': case '{': case '[': case '}': case ']':
+            if(*v!=','&&*v!='{'&&*v!='['&&*v!=']'&&*v!='}') {
+                /* skip index for topmost object */
+                n=k[0][0]=='{'?1:0;
+                /* worst case room for the path, the value and terminators */
+                for(need = 64, i = n; i <= l; i++)
+                    if(k[i][0]=='\"' && k[i]!=v) {
+                        for(s=e=k[i]+1; *e&&*e!='\"';) { if(*e=='\\') { e++; } e++; }
+                        need += e-s+1;
+                    } else need += 12;
+                if(*v=='\"') { for(s=e=v+1; *e&&*e!='\"';) { if(*e=='\\') { e++; } e++; } need += e-s; }
+                else { for(s=e=v; *e&&*e>' '&&*e!=','&&*e!=']'&&*e!='}';) e++; need += e-s; }
+                if(o + need > acap) {
+                    while(o + need > acap) acap += acap >> 1;
+                    json_arena = realloc(json_arena, acap);
+                    if(!json_arena) return 0;
+                }
+                if(json_num >= (int)icap) {
+                    icap += icap >> 1;
+                    json_idx = realloc(json_idx, icap * sizeof(json_idx_t));
+                    if(!json_idx) return 0;
+                }
+                /* dotted path */
+                json_idx[json_num].key = o;
+                for(i=n;i<=l;i++) {
+                    if(i!=n) json_arena[o++] = '.';
+                    if(k[i][0]=='\"' && k[i]!=v) {
+                        for(s=e=k[i]+1; *e&&*e!='\"';) { if(*e=='\\') { e++; } e++; }
+                        memcpy(json_arena + o, s, e-s); o += e-s;
+                    } else o += sprintf(json_arena + o, "%d", x[i]);
+                }
+                json_arena[o++] = 0;
+                /* value */
+                if(*v=='n') json_idx[json_num].val = -1;
+                else {
+                    if(*v=='\"') { for(s=e=v+1; *e&&*e!='\"';) { if(*e=='\\') { e++; } e++; } }
+                    else for(s=e=v; *e&&*e>' '&&*e!=','&&*e!=']'&&*e!='}';) e++;
+                    json_idx[json_num].val = o;
+                    memcpy(json_arena + o, s, e-s); o += e-s;
+                    json_arena[o++] = 0;
+                }
+                json_num++;
+            }
+            switch(*c) {
+            case 0:
+                qsort(json_idx, json_num, sizeof(json_idx_t), json_idxcmp);
+                json_src = jsonstr;
+                return 1;
+            case '{': case '[': x[++l]=0; if(l>=(int)sizeof(x)-1) return 0; break;
+            case '}': case ']': l--; break;
+            case ',': x[l]++; break;
+            }
+            j++;
+            break;
+        }
+        c++;
+    }
+}
+
+/**
+ * Drop the index. Must be called when the indexed document is freed, a new
+ * allocation could get the same address with different content
+ */
+void json_discard()
+{
+    if(json_idx) { free(json_idx); json_idx = NULL; }
+    if(json_arena) { free(json_arena); json_arena = NULL; }
+    json_num = 0; json_src = NULL;
+}
+
 /**
  * jsonstr: zero terminated UTF-8 string
  * key: path to a value, like "0.6.0.1" or "result.items.0.name"
  * returns the value in a malloc'd string or NULL
  */
-char *json_get(const char *jsonstr, char *key)
+static char *json_scan(const char *jsonstr, char *key)
 {
     char *m=key, *ret=NULL;
     unsigned char *c=(unsigned char*)jsonstr,*k[JSON_MAXPATHLEVEL+1];
@@ -107,3 +225,26 @@ end:if(!*m && e>s) {
     }
     return ret;
 }
+
+/**
+ * Indexed lookup, same contract as json_scan(): returns the value in a
+ * malloc'd string (owned by the caller) or NULL. The index is built on the
+ * first query and reused for every further key of the same document
+ */
+char *json_get(const char *jsonstr, char *key)
+{
+    json_idx_t *hit;
+    char *val, *ret;
+    long n;
+    if(!jsonstr || !jsonstr[0] || !key) return NULL;
+    if(jsonstr != json_src && !json_index(jsonstr))
+        return json_scan(jsonstr, key);
+    hit = bsearch(key, json_idx, json_num, sizeof(json_idx_t), json_findcmp);
+    if(!hit || hit->val < 0) return NULL;
+    val = json_arena + hit->val;
+    n = strlen(val);
+    if(!n) return NULL;
+    ret = malloc(n+1 < 256 ? 256 : n+1);
+    if(ret) { memset(ret,0,256); memcpy(ret,val,n); ret[n]=0; }
+    return ret;
+}
@@ -237,8 +237,7 @@ void len_open(gpt_t *gpt_entry)
     len_numblk = (gpt_entry->last - gpt_entry->start + 1);
     if(len_numblk < 32 + LEAN_BITMAPSIZE) { fprintf(stderr,"mkbootimg: partition #%d %s\r\n", fs_no, lang[ERR_NOSIZE]); exit(1); }
     fs_len = len_numblk * 512;
-    fs_base = realloc(fs_base, fs_len);
-    if(!fs_base) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
+    fs_reserve(fs_len);
     memset(fs_base, 0, fs_len);
     numband = len_numblk / ((1 << LEAN_LOG_BANDSIZE) * 512);
     if(numband < 1) numband = 1;
@@ -34,6 +34,8 @@
 #include <windows.h>
 #define ISHH(x) ((((x)>>30)&0xFFFFFFFF)==0xFFFFFFFF)
 #else
+#include <unistd.h>
+#include <sys/wait.h>
 #define ISHH(x) (((x)>>30)==0x3FFFFFFFF)
 #endif
 #if defined(MACOSX) || __WORDSIZE == 32
@@ -136,7 +138,12 @@ void parsejson(char *json)
         if(!tmp || !*tmp) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_NOINITRDTYPE]); exit(1); }
         if(strcmp(tmp, "fat16") && strcmp(tmp, "fat32"))
             for(i = 0; fsdrv[i].name && fsdrv[i].add; i++)
-                if(!strcmp(tmp, fsdrv[i].name)) { rd_open = fsdrv[i].open; rd_add = fsdrv[i].add; rd_close = fsdrv[i].close; break; }
+                if(!strcmp(tmp, fsdrv[i].name)) {
+                    rd_open = fsdrv[i].open; rd_add = fsdrv[i].add; rd_close = fsdrv[i].close;
+                    rd_addbegin = fsdrv[i].add_begin; rd_addchunk = fsdrv[i].add_chunk; rd_addend = fsdrv[i].add_end;
+                    rd_addlink = fsdrv[i].add_link;
+                    break;
+                }
         if(!rd_add) {
             fprintf(stderr,"mkbootimg: %s %s. %s:", lang[ERR_BADINITRDTYPE],tmp,lang[ERR_ACCEPTVALUES]);
             for(i = 0; fsdrv[i].name && fsdrv[i].add; i++) fprintf(stderr,"%s %s",i ? "," : "",fsdrv[i].name);
@@ -148,6 +155,20 @@ void parsejson(char *json)
     tmp = json_get(json, "initrd.gzip");
     if(tmp && tmp[0] != '1' && tmp[0] != 't' && tmp[0] != 'y') initrd_gzip = 0;
     free(tmp);
+    tmp = json_get(json, "initrd.gzip_threads");
+    if(tmp && *tmp) {
+        initrd_threads = atoi(tmp);
+        if(initrd_threads < 1) initrd_threads = 1;
+        if(initrd_threads > 256) initrd_threads = 256;
+    }
+    free(tmp);
+    tmp = json_get(json, "initrd.walk_threads");
+    if(tmp && *tmp) {
+        initrd_walkers = atoi(tmp);
+        if(initrd_walkers < 1) initrd_walkers = 1;
+        if(initrd_walkers > 64) initrd_walkers = 64;
+    }
+    free(tmp);
     tmp = json_get(json, "config");
     if(tmp && *tmp) {
         config = (char*)readfileall(tmp);
@@ -447,18 +468,256 @@ int flashmapadd(char *file)
     return 1;
 }
 
+/**
+ * Parse an octal field of a tar / cpio header
+ */
+static long int getoct(unsigned char *s, int n)
+{
+    long int v = 0;
+    while(n-- && *s >= '0' && *s <= '7') v = (v << 3) + (*s++ - '0');
+    return v;
+}
+
+/**
+ * Check one offset for a kernel header (ELF64 or PE32+)
+ */
+static int iskernelhdr(unsigned char *p)
+{
+    Elf64_Ehdr *ehdr = (Elf64_Ehdr*)p;
+    pe_hdr *pehdr = (pe_hdr*)(p + ((mz_hdr*)p)->peaddr);
+    return ((!memcmp(ehdr->e_ident,ELFMAG,SELFMAG)||!memcmp(ehdr->e_ident,"OS/Z",4)) &&
+        ehdr->e_ident[EI_CLASS]==ELFCLASS64 && ehdr->e_ident[EI_DATA]==ELFDATA2LSB) ||
+        (((mz_hdr*)p)->magic==MZ_MAGIC && ((mz_hdr*)p)->peaddr<65536 &&
+        pehdr->magic == PE_MAGIC && pehdr->file_type == PE_OPT_MAGIC_PE32PLUS);
+}
+
+/**
+ * Locate the kernel in a pre-built initrd image in fs_base. For tar and cpio
+ * archives the headers are walked looking for the path configured with
+ * "kernel=", which skips the byte scan entirely; everything else falls back
+ * to probing, with memchr() jumping between possible magic bytes instead of
+ * testing every offset. Returns the byte offset or -1
+ */
+long int locatekernel()
+{
+    unsigned char *p, *e, *a, *b, *o;
+    long int ns, size;
+    /* POSIX ustar: entry name is at the start of each 512 byte header */
+    if(kernelname && fs_len > 1024 && !memcmp(fs_base + 257, "ustar", 5))
+        for(p = fs_base; p + 1024 <= fs_base + fs_len && !memcmp(p + 257, "ustar", 5);) {
+            size = getoct(p + 124, 11);
+            if(!strncmp((char*)p, kernelname, 99) && p[strlen(kernelname) < 100 ? strlen(kernelname) : 99] == 0)
+                return p + 512 - fs_base;
+            p += 512 + ((size + 511) & ~511);
+        }
+    /* cpio with octal (odc) headers */
+    if(kernelname && fs_len > 76 && !memcmp(fs_base, "070707", 6))
+        for(p = fs_base; p + 76 <= fs_base + fs_len && !memcmp(p, "070707", 6);) {
+            ns = getoct(p + 59, 6); size = getoct(p + 65, 11);
+            if(p + 76 + ns > fs_base + fs_len) break;
+            if(!strcmp((char*)p + 76, kernelname)) return p + 76 + ns - fs_base;
+            p += 76 + ns + size;
+        }
+    /* fall back to scanning, narrowed to offsets that can start a magic */
+    e = fs_base + fs_len - 512;
+    for(p = fs_base; p && p <= e; p++) {
+        if(*p != 0x7f && *p != 'O' && *p != 'M') {
+            a = memchr(p, 0x7f, e - p + 1);
+            b = memchr(p, 'O', e - p + 1);
+            o = memchr(p, 'M', e - p + 1);
+            if(b && (!a || b < a)) a = b;
+            if(o && (!a || o < a)) a = o;
+            if(!a) break;
+            p = a;
+        }
+        if(iskernelhdr(p)) return p - fs_base;
+    }
+    return -1;
+}
+
+char *initrd_mft[NUMARCH] = {0};
+long int initrd_mftlen[NUMARCH] = {0};
+
+/**
+ * Collect one line per directory entry (size, mtime, path) into the manifest
+ */
+void initrd_manifest(char *directory, char **buf, long int *len, long int *cap)
+{
+    DIR *dir;
+    struct dirent *ent;
+    char full[MAXPATH];
+    struct stat st;
+    if ((dir = opendir(directory)) != NULL) {
+        while ((ent = readdir(dir)) != NULL) {
+            if(!strcmp(ent->d_name, ".") || !strcmp(ent->d_name, "..")) continue;
+            full[0] = 0;
+            strncat(full, directory, sizeof(full)-1);
+            strncat(full, "/", sizeof(full)-1);
+            strncat(full, ent->d_name, sizeof(full)-1);
+            if(stat(full, &st)) continue;
+            if(*len + MAXPATH + 64 > *cap) {
+                *cap += *cap >> 1;
+                *buf = realloc(*buf, *cap);
+                if(!*buf) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
+            }
+            *len += sprintf(*buf + *len, "%ld %ld %s\n", (long int)st.st_size, (long int)st.st_mtime, full);
+            if(S_ISDIR(st.st_mode)) initrd_manifest(full, buf, len, cap);
+        }
+        closedir(dir);
+    }
+}
+
+/**
+ * Reuse the initrd built by a previous run if nothing under its directory
+ * changed. The cache file next to the output holds the manifest the blob was
+ * built from; any size, mtime, path or option difference forces a rebuild.
+ * Returns 1 on a hit with initrd_buf[i] loaded
+ */
+int initrd_cacheload(int i, char *output)
+{
+    unsigned char *data;
+    char fn[MAXPATH];
+    uint64_t mlen;
+    long int cap = 65536, len;
+    int d;
+    if(!rd_add || !initrd_dir[i]) return 0;
+    for(d = 0; fsdrv[d].name && fsdrv[d].add != rd_add; d++);
+    initrd_mft[i] = malloc(cap);
+    if(!initrd_mft[i]) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
+    len = sprintf(initrd_mft[i], "%s %d %d %s\n", fsdrv[d].name ? fsdrv[d].name : "?",
+        initrd_gzip, initrd_threads, initrd_dir[i]);
+    initrd_manifest(initrd_dir[i], &initrd_mft[i], &len, &cap);
+    initrd_mftlen[i] = len;
+    sprintf(fn, "%s.%d.cache", output, i);
+    data = readfileall(fn);
+    if(!data) return 0;
+    if(read_size > (long int)(16 + len) && !memcmp(data, "IRDCACHE", 8)) {
+        memcpy(&mlen, data + 8, 8);
+        if((long int)mlen == len && !memcmp(data + 16, initrd_mft[i], len)) {
+            initrd_size[i] = read_size - 16 - len;
+            initrd_buf[i] = malloc(initrd_size[i]);
+            if(!initrd_buf[i]) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
+            memcpy(initrd_buf[i], data + 16 + len, initrd_size[i]);
+            free(data);
+            free(initrd_mft[i]); initrd_mft[i] = NULL;
+            return 1;
+        }
+    }
+    free(data);
+    return 0;
+}
+
+/**
+ * Store a freshly built initrd with its manifest for the next run
+ */
+void initrd_cachesave(int i, char *output)
+{
+    char fn[MAXPATH];
+    uint64_t mlen;
+    FILE *f;
+    if(!initrd_mft[i]) return;
+    sprintf(fn, "%s.%d.cache", output, i);
+    f = fopen(fn, "wb");
+    if(f) {
+        mlen = initrd_mftlen[i];
+        fwrite("IRDCACHE", 8, 1, f);
+        fwrite(&mlen, 8, 1, f);
+        fwrite(initrd_mft[i], initrd_mftlen[i], 1, f);
+        fwrite(initrd_buf[i], initrd_size[i], 1, f);
+        fclose(f);
+    }
+    free(initrd_mft[i]); initrd_mft[i] = NULL;
+}
+
+/**
+ * Build one architecture's initrd from its directory into fs_base / fs_len
+ */
+void initrd_build(int i)
+{
+    char pkey[32];
+    skipbytes = strlen(initrd_dir[i]) + 1;
+    fs_base = NULL; fs_len = fs_cap = 0; fs_no = 0;
+    profile_mark();
+    if(rd_open) (*rd_open)(NULL);
+    parsedir(initrd_dir[i], 0);
+    if(rd_close) (*rd_close)();
+    sprintf(pkey, "parsedir.%d", i); profile_stage(pkey, fs_len);
+    initrdcompress();
+    sprintf(pkey, "initrdcompress.%d", i); profile_stage(pkey, fs_len);
+}
+
+/**
+ * Build the per architecture initrds in parallel. The fsdrv add callbacks all work on
+ * process-wide state (fs_base and the drivers' own bookkeeping), so instead of threads
+ * each architecture gets its own worker process and sends the finished image back on a
+ * pipe. Falls back to the sequential path if there's only one initrd or no fork()
+ */
+void initrd_parallel(int nd)
+{
+#ifndef __WIN32__
+    int i, n, fds[NUMARCH][2], status;
+    long int len;
+    pid_t pid[NUMARCH];
+    unsigned char *buf;
+    if(nd < 2) return;
+    for(i = 0; i < NUMARCH; i++) {
+        pid[i] = -1;
+        if(!initrd_dir[i] || initrd_buf[i]) continue;
+        if(pipe(fds[i])) continue;
+        pid[i] = fork();
+        if(pid[i] < 0) { close(fds[i][0]); close(fds[i][1]); continue; }
+        if(!pid[i]) {
+            /* worker: build this initrd and stream it to the parent */
+            close(fds[i][0]);
+            initrd_build(i);
+            len = fs_len;
+            if(write(fds[i][1], &len, sizeof(len)) != sizeof(len)) exit(1);
+            for(len = 0; len < fs_len; len += n) {
+                n = write(fds[i][1], fs_base + len, fs_len - len);
+                if(n < 1) exit(1);
+            }
+            exit(0);
+        }
+        close(fds[i][1]);
+    }
+    for(i = 0; i < NUMARCH; i++) {
+        if(pid[i] < 0) continue;
+        len = 0;
+        if(read(fds[i][0], &len, sizeof(len)) != sizeof(len) || len < 1)
+            { fprintf(stderr,"mkbootimg: %s initrd #%d\r\n",lang[ERR_NOINITRD],i+1); exit(1); }
+        buf = malloc(len);
+        if(!buf) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
+        for(fs_len = 0; fs_len < len; fs_len += n) {
+            n = read(fds[i][0], buf + fs_len, len - fs_len);
+            if(n < 1) { fprintf(stderr,"mkbootimg: %s initrd #%d\r\n",lang[ERR_NOINITRD],i+1); exit(1); }
+        }
+        close(fds[i][0]);
+        waitpid(pid[i], &status, 0);
+        if(!WIFEXITED(status) || WEXITSTATUS(status)) exit(1);
+        initrd_buf[i] = buf;
+        initrd_size[i] = len;
+    }
+#else
+    (void)nd;
+#endif
+}
+
 /**
  * Main function
  */
 int main(int argc, char **argv)
 {
-    Elf64_Ehdr *ehdr;
-    pe_hdr *pehdr;
-    int i, j;
-    unsigned char *data;
-    char kfn[32768];
+    int i, nd = 0, pair, reuse, prev_gzip = -1, prev_size[NUMARCH] = {0};
+    long int kofs;
+    unsigned char *data, *prev_buf[NUMARCH] = {0};
+    char kfn[32768], *prev_dir[NUMARCH] = {0}, *bdir[NUMARCH], prev_arch[NUMARCH] = {0};
     FILE *f;
+    crc32c_init();
     argv = getlang(&argc, argv);
+    while(argc > 1 && argv[1] && (!strcmp(argv[1], "--profile") || !strcmp(argv[1], "--verify"))) {
+        if(argv[1][2] == 'p') profile = 1; else verify = 1;
+        argc--; argv++;
+    }
     if(argc < 3 || argv[1]==NULL || argv[2] == NULL || !strcmp(argv[1],"help")) {
         printf( "BOOTBOOT mkbootimg utility - bztsrc@gitlab\r\n BOOTBOOT Copyright (c) bzt MIT "
                 "https://gitlab.com/bztsrc/bootboot\r\n%s\r\n"
@@ -469,8 +728,9 @@ int main(int argc, char **argv)
                 "  ./mkbootimg check <kernel elf / pe>\r\n"
                 "  ./mkbootimg <%s> initrd.rom\r\n"
                 "  ./mkbootimg <%s> bootpart.bin\r\n"
-                "  ./mkbootimg <%s> <%s>\r\n\r\n",lang[HELP3],lang[HELP4],
-                lang[HELP4],lang[HELP4],lang[HELP5]);
+                "  ./mkbootimg <%s> <%s>\r\n"
+                "  ./mkbootimg <%s> <%s> [<%s> <%s> ...]\r\n\r\n",lang[HELP3],lang[HELP4],
+                lang[HELP4],lang[HELP4],lang[HELP5],lang[HELP4],lang[HELP5],lang[HELP4],lang[HELP5]);
         printf( "%s:\n"
                 "  ./mkbootimg check mykernel/c/mykernel.x86_64.elf\r\n"
                 "  ./mkbootimg myos.json initrd.rom\r\n"
@@ -484,64 +744,101 @@ int main(int argc, char **argv)
         if(!data || read_size < 16) { fprintf(stderr,"mkbootimg: %s %s\r\n",lang[ERR_KRNL],argv[2]); exit(1); }
         parsekernel(0, data, 1);
     } else {
+      /* batch mode: every <config> <output> pair on the command line is one
+       * image variant, and the expensive intermediates (the packed and
+       * compressed initrds, the parsed kernel metadata) are carried over to
+       * the next variant whenever its initrd configuration is unchanged */
+      for(pair = 1; pair + 1 < argc; pair += 2) {
         t = time(NULL);
         ts = gmtime(&t);
+        /* globals which parsejson() only sets conditionally, and which
+         * gpt_maketable() mutates, must go back to their start-up values */
+        disk_size = 0; disk_align = 0; iso9660 = 0; boot_fat = 16;
+        bbp_start = bbp_end = 0;
+        initrd_gzip = 1; initrd_threads = 1; initrd_walkers = 4;
         memset(kfn, 0, sizeof(kfn)); /* <- make valgrind happy with sprintf */
-        json = (char*)readfileall(argv[1]);
-        if(!json || !*json) { fprintf(stderr,"mkbootimg: %s %s\r\n",lang[ERR_JSON],argv[1]); exit(1); }
+        json = (char*)readfileall(argv[pair]);
+        if(!json || !*json) { fprintf(stderr,"mkbootimg: %s %s\r\n",lang[ERR_JSON],argv[pair]); exit(1); }
+        profile_mark();
         parsejson(json);
+        profile_stage("parsejson", (long int)strlen(json));
         parseconfig();
+        /* copies of the directory names, for change detection across variants */
         for(i = 0; i < NUMARCH; i++)
+            if(initrd_dir[i]) {
+                bdir[i] = (char*)malloc(strlen(initrd_dir[i]) + 1);
+                if(!bdir[i]) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
+                strcpy(bdir[i], initrd_dir[i]);
+            } else bdir[i] = NULL;
+        reuse = prev_buf[0] && prev_gzip == initrd_gzip;
+        for(i = 0; i < NUMARCH; i++) {
+            if(initrd_buf[i]) reuse = 0;    /* file based initrd, loaded per variant */
+            if((bdir[i] != NULL) != (prev_dir[i] != NULL) ||
+               (bdir[i] && strcmp(bdir[i], prev_dir[i]))) reuse = 0;
+        }
+        if(reuse) {
+            for(i = 0; i < NUMARCH; i++) {
+                if(initrd_dir[i]) { free(initrd_dir[i]); initrd_dir[i] = NULL; }
+                initrd_buf[i] = prev_buf[i]; initrd_size[i] = prev_size[i]; initrd_arch[i] = prev_arch[i];
+            }
+        } else {
+          for(i = 0; i < NUMARCH; i++)
+              if(prev_buf[i]) { free(prev_buf[i]); prev_buf[i] = NULL; }
+          nd = 0;
+          for(i = 0; i < NUMARCH; i++)
             if(initrd_dir[i]) {
                 sprintf(kfn, "%s/%s", initrd_dir[i], kernelname);
+                profile_mark();
                 data = readfileall(kfn);
                 if(!data || read_size < 16) { fprintf(stderr,"mkbootimg: %s %s\r\n",lang[ERR_KRNL],kfn); exit(1); }
                 if(!memcmp(data + 54, "FAT1", 4) || !memcmp(data + 82, "FAT3", 4))
                     { fprintf(stderr,"mkbootimg: %s %s\r\n", lang[ERR_BADINITRDTYPE],"FAT"); exit(1); }
                 parsekernel(i, data, 0);
+                profile_stage("parsekernel", read_size);
                 free(data);
-                skipbytes = strlen(initrd_dir[i]) + 1;
-                fs_base = NULL; fs_len = 0; fs_no = 0;
-                if(rd_open) (*rd_open)(NULL);
-                parsedir(initrd_dir[i], 0);
-                if(rd_close) (*rd_close)();
-                initrdcompress();
-                initrd_buf[i] = fs_base;
-                initrd_size[i] = fs_len;
-                free(initrd_dir[i]);
+                if(initrd_cacheload(i, argv[pair+1]))
+                    profile_stage("initrdcache", initrd_size[i]);
+                nd++;
             } else
             if(initrd_buf[i]) {
-                fs_base = initrd_buf[i]; fs_len = initrd_size[i];
+                fs_base = initrd_buf[i]; fs_len = fs_cap = initrd_size[i];
                 if(initrd_buf[i][0] == 0x1f && initrd_buf[i][1] == 0x8b) {
                     initrduncompress(); initrd_buf[i] = fs_base; initrd_size[i] = fs_len; }
-                for(j = 0, kfn[0] = 0; j < fs_len - 512; j++) {
-                    ehdr=(Elf64_Ehdr *)(fs_base + j);
-                    pehdr=(pe_hdr*)(fs_base + j + ((mz_hdr*)(fs_base + j))->peaddr);
-                    if(((!memcmp(ehdr->e_ident,ELFMAG,SELFMAG)||!memcmp(ehdr->e_ident,"OS/Z",4)) &&
-                        ehdr->e_ident[EI_CLASS]==ELFCLASS64 && ehdr->e_ident[EI_DATA]==ELFDATA2LSB) ||
-                        (((mz_hdr*)(fs_base + j))->magic==MZ_MAGIC && ((mz_hdr*)(fs_base + j))->peaddr<65536 &&
-                        pehdr->magic == PE_MAGIC && pehdr->file_type == PE_OPT_MAGIC_PE32PLUS)) {
-                            parsekernel(i, fs_base + j, 0);
-                            kfn[0] = 1;
-                            break;
-                        }
+                kfn[0] = 0;
+                if((kofs = locatekernel()) >= 0) {
+                    parsekernel(i, fs_base + kofs, 0);
+                    kfn[0] = 1;
                 }
                 if(!kfn[0]) { fprintf(stderr,"mkbootimg: %s initrd #%d\r\n",lang[ERR_LOCKRNL],i+1); exit(1); }
                 if(initrd_gzip) { initrdcompress(); initrd_buf[i] = fs_base; initrd_size[i] = fs_len; }
             } else
                 break;
-        if(initrd_arch[1] && initrd_arch[1] == initrd_arch[0]) { initrd_size[1] = 0; initrd_arch[1] = 0; }
-        if(!strcmp(argv[2], "initrd.rom")) makerom(); else
-        if(!strcmp(argv[2], "initrd.bin")) {
+          initrd_parallel(nd);
+          for(i = 0; i < NUMARCH; i++)
+            if(initrd_dir[i]) {
+                if(!initrd_buf[i]) {
+                    initrd_build(i);
+                    initrd_buf[i] = fs_base;
+                    initrd_size[i] = fs_len;
+                }
+                initrd_cachesave(i, argv[pair+1]);
+                free(initrd_dir[i]); initrd_dir[i] = NULL;
+            }
+          if(initrd_arch[1] && initrd_arch[1] == initrd_arch[0]) { initrd_size[1] = 0; initrd_arch[1] = 0; }
+        }
+        if(!strcmp(argv[pair+1], "initrd.rom")) makerom(); else
+        if(!strcmp(argv[pair+1], "initrd.bin")) {
             /* write out */
             f=fopen("initrd.bin","wb");
             if(!f) { fprintf(stderr,"mkbootimg: %s %s\r\n", lang[ERR_WRITE], "initrd.bin"); exit(3); }
             fwrite(initrd_buf[0],initrd_size[0],1,f);
             fclose(f);
             printf("mkbootimg: %s %s.\r\n", "initrd.bin", lang[SAVED]);
-        } else if(!flashmapadd(argv[2])) {
+        } else if(!flashmapadd(argv[pair+1])) {
+            profile_mark();
             esp_makepart();
-            if(!strcmp(argv[2], "bootpart.bin")) {
+            profile_stage("esp_makepart", esp_size);
+            if(!strcmp(argv[pair+1], "bootpart.bin")) {
                 /* write out */
                 f=fopen("bootpart.bin","wb");
                 if(!f) { fprintf(stderr,"mkbootimg: %s %s\r\n", lang[ERR_WRITE], "bootpart.bin"); exit(3); }
@@ -549,18 +846,33 @@ int main(int argc, char **argv)
                 fclose(f);
                 printf("mkbootimg: %s %s.\r\n", "bootpart.bin", lang[SAVED]);
             } else {
+                profile_mark();
                 gpt_maketable();
-                img_write(argv[2]);
+                profile_stage("gpt_maketable", es*512);
+                img_write(argv[pair+1]);
+                profile_stage("img_write", tsize);
+                if(verify) { img_verify(argv[pair+1]); profile_stage("img_verify", tsize); }
                 free(gpt);
             }
             free(esp);
         }
-        free(kernelname);
-        free(initrd_buf[0]);
-        if(initrd_buf[1]) free(initrd_buf[1]);
-        if(initrd_buf[2]) free(initrd_buf[2]);
-        if(config) free(config);
-        free(json);
+        /* keep the intermediates for the next variant */
+        for(i = 0; i < NUMARCH; i++) {
+            prev_buf[i] = initrd_buf[i]; prev_size[i] = initrd_size[i]; prev_arch[i] = initrd_arch[i];
+            if(prev_dir[i]) free(prev_dir[i]);
+            prev_dir[i] = bdir[i];
+        }
+        prev_gzip = initrd_gzip;
+        free(kernelname); kernelname = NULL;
+        if(config) { free(config); config = NULL; }
+        json_discard();
+        free(json); json = NULL;
+      }
+      for(i = 0; i < NUMARCH; i++) {
+        if(prev_buf[i]) free(prev_buf[i]);
+        if(prev_dir[i]) free(prev_dir[i]);
+      }
+      profile_report();
     }
     return 0;
 }
@@ -172,6 +172,10 @@ typedef struct {
 typedef void (*initrd_open)(gpt_t *gpt_entry);
 typedef void (*initrd_add)(struct stat *st, char *name, unsigned char *content, int size);
 typedef void (*initrd_close)();
+typedef void (*initrd_addbegin)(struct stat *st, char *name);
+typedef void (*initrd_addchunk)(unsigned char *chunk, int size);
+typedef void (*initrd_addend)();
+typedef void (*initrd_addlink)(struct stat *st, char *name, char *target, long int toffs);
 
 typedef struct {
     char *name;
@@ -179,13 +183,25 @@ typedef struct {
     initrd_open open;
     initrd_add add;
     initrd_close close;
+    /* optional streaming ingestion, for drivers which store file data
+     * sequentially. Large files are fed in fixed size windows so that they
+     * don't have to be slurped into memory in one piece. Drivers providing
+     * these are append-only by nature, so when they build a data partition
+     * their output also goes directly to the image file (see fs_emit)
+     * instead of being buffered in fs_base first */
+    initrd_addbegin add_begin;
+    initrd_addchunk add_chunk;
+    initrd_addend add_end;
+    /* optional hard link support: add name as another link to target, which
+     * was added earlier at offset toffs in the partition image */
+    initrd_addlink add_link;
 } fsdrv_t;
 
 extern time_t t;
 extern struct tm *ts;
 extern guid_t diskguid;
 extern char *json, *config, *kernelname, *initrd_dir[NUMARCH], initrd_arch[NUMARCH];
-extern int fs_len, fs_no, initrd_size[NUMARCH], initrd_gzip, boot_size, boot_fat, disk_size, esp_size, esp_bbs;
+extern int fs_len, fs_cap, fs_no, initrd_size[NUMARCH], initrd_gzip, initrd_threads, initrd_walkers, boot_size, boot_fat, disk_size, esp_size, esp_bbs;
 extern int iso9660, skipbytes, np, bbp_start, bbp_end;
 extern unsigned char *esp, *gpt, gpt2[512], *fs_base, *initrd_buf[NUMARCH];
 extern unsigned long int tsize, es, esiz, disk_align, gpt_parts[248];
@@ -193,17 +209,39 @@ extern fsdrv_t fsdrv[];
 extern initrd_open rd_open;
 extern initrd_add rd_add;
 extern initrd_close rd_close;
+extern initrd_addbegin rd_addbegin;
+extern initrd_addchunk rd_addchunk;
+extern initrd_addend rd_addend;
+extern initrd_addlink rd_addlink;
+
+extern int profile, verify;
+extern long int fs_reallocs;
+void profile_mark();
+void profile_stage(char *stage, long int bytes);
+void profile_report();
 
 extern long int read_size;
 unsigned char* readfileall(char *file);
 unsigned int gethex(char *ptr, int len);
 void getguid(char *ptr, guid_t *guid);
+void fs_reserve(int len);
+extern FILE *fs_out;
+extern unsigned long int fs_out_offs;
+void fs_emit(unsigned char *buf, int len);
+void fs_emitzero(int len);
+void fs_patch(long int offs, unsigned char *buf, int len);
+void fs_fetch(long int offs, unsigned char *buf, int len);
+long int parsedirsize(char *directory);
 void parsedir(char *directory, int parent);
 void initrdcompress();
 void initrduncompress();
 char *json_get(const char *jsonstr, char *key);
+void json_discard();
 unsigned char * stbi_zlib_compress(unsigned char *data, int data_len, int *out_len, int quality);
 void esp_makepart();
 void gpt_maketable();
 void img_write(char *fn);
+void img_verify(char *fn);
+void crc32c_init();
 uint32_t crc32_calc(unsigned char *start,int length);
+uint32_t crc32_cont(uint32_t crc32_val, unsigned char *start, int length);
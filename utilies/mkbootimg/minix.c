@@ -264,8 +264,7 @@ void mnx_open(gpt_t *gpt_entry)
     if(mnx_numblk < 8) { fprintf(stderr,"mkbootimg: partition #%d %s\r\n", fs_no, lang[ERR_NOSIZE]); exit(1); }
     /* "format" the partition to Minix3FS */
     fs_len = mnx_numblk * DEFAULT_BLOCK_SIZE;
-    fs_base = realloc(fs_base, fs_len);
-    if(!fs_base) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
+    fs_reserve(fs_len);
     memset(fs_base, 0, fs_len);
     sup = (superblock_t*)(fs_base + 1024);
     kb = fs_len / 1024;
@@ -40,12 +40,9 @@ void tar_open(gpt_t *gpt_entry)
 
 void tar_add(struct stat *st, char *name, unsigned char *content, int size)
 {
-    unsigned char *end;
+    unsigned char hdr[512], *end = hdr;
     int i, j = 0;
     if(!S_ISREG(st->st_mode) && !S_ISDIR(st->st_mode) && !S_ISLNK(st->st_mode)) return;
-    fs_base = realloc(fs_base, fs_len + 512 + ((size + 511) & ~511));
-    if(!fs_base) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
-    end = fs_base + fs_len;
     memset(end, 0, 512);
     strncpy((char*)end, name, 99);
     sprintf((char*)end + 100, "%07o", st->st_mode & 077777);
@@ -61,9 +58,62 @@ void tar_add(struct stat *st, char *name, unsigned char *content, int size)
     for(i = 0; i < 512; i++) j += end[i];
     for(i = 0; i < 8; i++) j += ' ' - end[148 + i];
     sprintf((char*)end + 148, "%06o", j);
-    end += 512;
-    if(content && size) { memcpy(end, content, size); memset(end + size, 0, ((size + 511) & ~511) - size); }
-    fs_len += 512 + ((size + 511) & ~511);
+    fs_emit(hdr, 512);
+    if(content && size) { fs_emit(content, size); fs_emitzero(((size + 511) & ~511) - size); }
+}
+
+void tar_addbegin(struct stat *st, char *name)
+{
+    unsigned char hdr[512], *end = hdr;
+    int i, j = 0;
+    memset(end, 0, 512);
+    strncpy((char*)end, name, 99);
+    sprintf((char*)end + 100, "%07o", st->st_mode & 077777);
+    sprintf((char*)end + 108, "%07o", 0);
+    sprintf((char*)end + 116, "%07o", 0);
+    sprintf((char*)end + 124, "%011o", (int)st->st_size);
+    sprintf((char*)end + 136, "%011o", 0);
+    sprintf((char*)end + 148, "%06o", 0);
+    sprintf((char*)end + 155, " %1d", 0);
+    memcpy(end + 257, "ustar  ", 7);
+    memcpy(end + 265, "root", 4); memcpy(end + 297, "root", 4);
+    for(i = 0; i < 512; i++) j += end[i];
+    for(i = 0; i < 8; i++) j += ' ' - end[148 + i];
+    sprintf((char*)end + 148, "%06o", j);
+    fs_emit(hdr, 512);
+}
+
+void tar_addchunk(unsigned char *chunk, int size)
+{
+    fs_emit(chunk, size);
+}
+
+void tar_addend()
+{
+    fs_emitzero((512 - (fs_len & 511)) & 511);
+}
+
+void tar_addlink(struct stat *st, char *name, char *target, long int toffs)
+{
+    unsigned char hdr[512], *end = hdr;
+    int i, j = 0;
+    (void)toffs;
+    memset(end, 0, 512);
+    strncpy((char*)end, name, 99);
+    sprintf((char*)end + 100, "%07o", st->st_mode & 077777);
+    sprintf((char*)end + 108, "%07o", 0);
+    sprintf((char*)end + 116, "%07o", 0);
+    sprintf((char*)end + 124, "%011o", 0);
+    sprintf((char*)end + 136, "%011o", 0);
+    sprintf((char*)end + 148, "%06o", 0);
+    sprintf((char*)end + 155, " %1d", 1);
+    strncpy((char*)end + 157, target, 99);
+    memcpy(end + 257, "ustar  ", 7);
+    memcpy(end + 265, "root", 4); memcpy(end + 297, "root", 4);
+    for(i = 0; i < 512; i++) j += end[i];
+    for(i = 0; i < 8; i++) j += ' ' - end[148 + i];
+    sprintf((char*)end + 148, "%06o", j);
+    fs_emit(hdr, 512);
 }
 
 void tar_close()
@@ -30,6 +30,13 @@
 #include "main.h"
 #define __USE_XOPEN_EXTENDED 1  /* for readlink() */
 #include <unistd.h>
+#ifndef __WIN32__
+#define __USE_XOPEN2K 1         /* for posix_fadvise() */
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
 
 #ifdef __WIN32__
 int readlink(char *path, char *target, int len) {
@@ -45,13 +52,74 @@ struct tm *ts;
 guid_t diskguid;
 char *json = NULL, *config = NULL, *kernelname = NULL, *initrd_dir[NUMARCH] = {0}, *initrd_file[NUMARCH] = {0};
 char initrd_arch[NUMARCH] = {0};
-int fs_len, fs_no, initrd_size[NUMARCH] = {0}, initrd_gzip = 1, boot_size = 0, boot_fat = 16, disk_size = 0;
+int fs_len, fs_cap = 0, fs_no, initrd_size[NUMARCH] = {0}, initrd_gzip = 1, initrd_threads = 1, initrd_walkers = 4, boot_size = 0, boot_fat = 16, disk_size = 0;
 int iso9660 = 0, skipbytes = 0;
 unsigned char *fs_base = NULL, *initrd_buf[NUMARCH] = {0};
 unsigned long int tsize = 0, es = 0, esiz = 0, disk_align = 0;
 initrd_open rd_open = NULL;
 initrd_add rd_add = NULL;
 initrd_close rd_close = NULL;
+initrd_addbegin rd_addbegin = NULL;
+initrd_addchunk rd_addchunk = NULL;
+initrd_addend rd_addend = NULL;
+initrd_addlink rd_addlink = NULL;
+int profile = 0, verify = 0;
+long int fs_reallocs = 0;
+static long int profile_start = 0, profile_last = 0;
+
+/**
+ * Wall clock in microseconds for the --profile report
+ */
+static long int profile_now()
+{
+#ifndef __WIN32__
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000L + tv.tv_usec;
+#else
+    return (long int)time(NULL) * 1000000L;
+#endif
+}
+
+/**
+ * Start measuring a stage
+ */
+void profile_mark()
+{
+    if(!profile) return;
+    profile_last = profile_now();
+    if(!profile_start) profile_start = profile_last;
+}
+
+/**
+ * Report one finished stage on stderr, one parseable line each
+ */
+void profile_stage(char *stage, long int bytes)
+{
+    long int now, us;
+    if(!profile) return;
+    now = profile_now();
+    if(!profile_start) profile_start = profile_last = now;
+    us = now - profile_last;
+    fprintf(stderr, "mkbootimg-profile: stage=%s usec=%ld bytes=%ld mbps=%ld\r\n",
+        stage, us, bytes, us > 0 ? bytes / us : 0);
+    profile_last = now;
+}
+
+/**
+ * Closing summary: total wall time, peak RSS and image buffer realloc count
+ */
+void profile_report()
+{
+    long int rss = 0;
+#ifndef __WIN32__
+    struct rusage ru;
+    if(!getrusage(RUSAGE_SELF, &ru)) rss = ru.ru_maxrss;
+#endif
+    if(!profile) return;
+    fprintf(stderr, "mkbootimg-profile: total usec=%ld maxrss_kb=%ld fs_reallocs=%ld\r\n",
+        profile_now() - profile_start, rss, fs_reallocs);
+}
 
 /**
  * Read a file entirely into memory. Don't use it with partition image files
@@ -110,42 +178,497 @@ void getguid(char *ptr, guid_t *guid)
 }
 
 /**
- * Recursively parse a directory
+ * Make sure the output image buffer has room for at least len bytes. Grows the
+ * buffer geometrically so that adding files costs amortized O(1) reallocs instead
+ * of one realloc (and potentially a full copy of the image so far) per file
  */
-void parsedir(char *directory, int parent)
+void fs_reserve(int len)
+{
+    int cap;
+    if(fs_base && len <= fs_cap) return;
+    cap = fs_cap < 1024*1024 ? 1024*1024 : fs_cap;
+    while(cap < len) cap += cap >> 1;
+    fs_base = realloc(fs_base, cap);
+    if(!fs_base) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
+    fs_cap = cap;
+    fs_reallocs++;
+}
+
+/**
+ * When set, the file system driver output streams directly to this file
+ * instead of accumulating in fs_base. Only append-only drivers (the ones
+ * with add_begin / add_chunk / add_end) are run in this mode; fs_out_offs
+ * is the image file offset where the partition starts, so driver-relative
+ * offsets can be patched in place
+ */
+FILE *fs_out = NULL;
+unsigned long int fs_out_offs = 0;
+
+/**
+ * Append driver output: to the image file when streaming, to fs_base otherwise.
+ * fs_len tracks the partition-relative offset in both modes
+ */
+void fs_emit(unsigned char *buf, int len)
+{
+    if(len < 1) return;
+    if(fs_out) {
+        if(fwrite(buf, len, 1, fs_out) != 1) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_WRITE]); exit(3); }
+    } else {
+        fs_reserve(fs_len + len);
+        memcpy(fs_base + fs_len, buf, len);
+    }
+    fs_len += len;
+}
+
+/**
+ * Append a run of zeros (alignment padding). When streaming it just seeks
+ * forward, leaving a hole the OS doesn't have to store
+ */
+void fs_emitzero(int len)
+{
+    if(len < 1) return;
+    if(fs_out)
+        fseek(fs_out, len, SEEK_CUR);
+    else {
+        fs_reserve(fs_len + len);
+        memset(fs_base + fs_len, 0, len);
+    }
+    fs_len += len;
+}
+
+/**
+ * Overwrite len bytes at an earlier partition-relative offset (cpio hard
+ * links retrofit the inode and link count of the first copy)
+ */
+void fs_patch(long int offs, unsigned char *buf, int len)
+{
+    long int pos;
+    if(fs_out) {
+        pos = ftell(fs_out);
+        fseek(fs_out, fs_out_offs + offs, SEEK_SET);
+        fwrite(buf, len, 1, fs_out);
+        fseek(fs_out, pos, SEEK_SET);
+    } else
+        memcpy(fs_base + offs, buf, len);
+}
+
+/**
+ * Read back len bytes from an earlier partition-relative offset
+ */
+void fs_fetch(long int offs, unsigned char *buf, int len)
+{
+    long int pos;
+    if(fs_out) {
+        pos = ftell(fs_out);
+        fflush(fs_out);
+        fseek(fs_out, fs_out_offs + offs, SEEK_SET);
+        if(fread(buf, 1, len, fs_out) != (size_t)len) memset(buf, 0, len);
+        fseek(fs_out, pos, SEEK_SET);
+    } else
+        memcpy(buf, fs_base + offs, len);
+}
+
+/**
+ * Estimate the packed size of a directory tree, used to reserve the image buffer up-front
+ */
+long int parsedirsize(char *directory)
 {
     DIR *dir;
     struct dirent *ent;
     char full[MAXPATH];
-    unsigned char *tmp;
     struct stat st;
+    long int size = 0;
 
     if ((dir = opendir(directory)) != NULL) {
         while ((ent = readdir(dir)) != NULL) {
-            if(!parent && (!strcmp(ent->d_name, ".") || !strcmp(ent->d_name, ".."))) continue;
+            if(!strcmp(ent->d_name, ".") || !strcmp(ent->d_name, "..")) continue;
             full[0] = 0;
             strncat(full, directory, sizeof(full)-1);
             strncat(full, "/", sizeof(full)-1);
             strncat(full, ent->d_name, sizeof(full)-1);
             if(stat(full, &st)) continue;
-            if(S_ISDIR(st.st_mode)) {
-                (*rd_add)(&st, full + skipbytes, NULL, 0);
-                if(strcmp(ent->d_name, ".") && strcmp(ent->d_name, ".."))
-                    parsedir(full, parent+1);
-            } else {
-                tmp = NULL; read_size = 0;
-                if(S_ISREG(st.st_mode)) tmp = readfileall(full); else
-                if(S_ISLNK(st.st_mode)) {
-                    tmp = malloc(MAXPATH); if(!tmp) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
-                    read_size=readlink(full,(char*)tmp,MAXPATH-1); tmp[read_size]=0;
-                }
-                (*rd_add)(&st, full + skipbytes, tmp, read_size);
-                if(tmp) free(tmp);
-            }
+            /* generous per entry overhead, covers headers, padding and inodes */
+            size += 1024;
+            if(S_ISDIR(st.st_mode)) size += parsedirsize(full);
+            else size += (st.st_size + 511) & ~511;
         }
         closedir(dir);
     }
+    return size;
+}
+
+/**
+ * Window buffer for the streaming ingestion path. Only one file is streamed
+ * at any time, so the recursive walker can share it
+ */
+static unsigned char strmbuf[1024*1024];
+
+/**
+ * Content-addressed index of regular files already in the image, used to emit
+ * duplicates as hard links when the driver supports those. Open addressed
+ * hash table keyed on the CRC32c of the file contents
+ */
+typedef struct {
+    uint32_t crc;
+    long int size;
+    long int offs;              /* partition image offset of the first copy */
+    char *path;                 /* archive path of the first copy */
+    char *full;                 /* on-disk path, for the byte-exact check */
+} dedup_t;
+static dedup_t *dedup = NULL;
+static long int dedup_num = 0, dedup_cap = 0;
+
+/**
+ * Hash a file without keeping it in memory
+ */
+static uint32_t dedup_hash(char *full)
+{
+    FILE *f;
+    size_t r;
+    uint32_t crc = 0;
+    if(!(f = fopen(full, "rb"))) return 0;
+    while((r = fread(strmbuf, 1, sizeof(strmbuf), f)) > 0)
+        crc = crc32_cont(crc, strmbuf, (int)r);
+    fclose(f);
+    return crc;
+}
+
+/**
+ * Byte-exact comparison of two files, guards against CRC collisions
+ */
+static int dedup_samefile(char *a, char *b, long int size)
+{
+    FILE *fa, *fb;
+    size_t ra, rb;
+    int same = 1;
+    if(!(fa = fopen(a, "rb"))) return 0;
+    if(!(fb = fopen(b, "rb"))) { fclose(fa); return 0; }
+    while(size > 0 && same) {
+        ra = fread(strmbuf, 1, sizeof(strmbuf)/2, fa);
+        rb = fread(strmbuf + sizeof(strmbuf)/2, 1, sizeof(strmbuf)/2, fb);
+        if(ra != rb || !ra || memcmp(strmbuf, strmbuf + sizeof(strmbuf)/2, ra)) same = 0;
+        size -= ra;
+    }
+    fclose(fa); fclose(fb);
+    return same;
+}
+
+/**
+ * Look up a file in the dedup index, adding it if it's the first of its kind.
+ * Returns the earlier entry with identical content or NULL
+ */
+static dedup_t *dedup_find(uint32_t crc, char *full, char *path, long int size)
+{
+    dedup_t *nt;
+    long int i, j, mask;
+    if(dedup_num * 4 >= dedup_cap * 3) {
+        i = dedup_cap < 256 ? 256 : dedup_cap * 2;
+        nt = (dedup_t*)malloc(i * sizeof(dedup_t));
+        if(!nt) return NULL;
+        memset(nt, 0, i * sizeof(dedup_t));
+        for(j = 0; j < dedup_cap; j++)
+            if(dedup[j].full) {
+                mask = dedup[j].crc & (i - 1);
+                while(nt[mask].full) mask = (mask + 1) & (i - 1);
+                nt[mask] = dedup[j];
+            }
+        if(dedup) free(dedup);
+        dedup = nt; dedup_cap = i;
+    }
+    mask = dedup_cap - 1;
+    for(i = crc & mask; dedup[i].full; i = (i + 1) & mask)
+        if(dedup[i].crc == crc && dedup[i].size == size && dedup_samefile(dedup[i].full, full, size))
+            return &dedup[i];
+    dedup[i].crc = crc; dedup[i].size = size; dedup[i].offs = fs_len;
+    dedup[i].path = (char*)malloc(strlen(path) + 1);
+    dedup[i].full = (char*)malloc(strlen(full) + 1);
+    if(!dedup[i].path || !dedup[i].full) { dedup[i].full = NULL; return NULL; }
+    strcpy(dedup[i].path, path);
+    strcpy(dedup[i].full, full);
+    dedup_num++;
+    return NULL;
+}
+
+/**
+ * Drop the dedup index between partitions, archive paths aren't comparable across them
+ */
+static void dedup_free()
+{
+    long int i;
+    for(i = 0; i < dedup_cap; i++)
+        if(dedup[i].full) { free(dedup[i].path); free(dedup[i].full); }
+    if(dedup) free(dedup);
+    dedup = NULL; dedup_num = dedup_cap = 0;
+}
+
+/**
+ * Emit one directory entry to the file system driver, preferring content and
+ * hashes the readahead workers already pulled in (both NULL / zero when the
+ * entry comes from the serial walk)
+ */
+static void parseent(char *full, struct stat *st, int parent, unsigned char *data, long int dsize, uint32_t crc, int hashed)
+{
+    unsigned char *tmp;
+    char *base;
+    FILE *f;
+    size_t r;
+    long int o;
+    dedup_t *dup;
+
+    base = strrchr(full, '/');
+    base = base ? base + 1 : full;
+    if(S_ISDIR(st->st_mode)) {
+        (*rd_add)(st, full + skipbytes, NULL, 0);
+        if(strcmp(base, ".") && strcmp(base, ".."))
+            parsedir(full, parent+1);
+        return;
+    }
+    if(S_ISREG(st->st_mode) && rd_addlink && st->st_size > 0) {
+        /* already got a byte-identical file? emit a hard link instead of a second copy */
+        dup = dedup_find(hashed ? crc : dedup_hash(full), full, full + skipbytes, (long int)st->st_size);
+        if(dup) {
+            (*rd_addlink)(st, full + skipbytes, dup->path, dup->offs);
+            return;
+        }
+    }
+    if(S_ISREG(st->st_mode) && rd_addbegin && data) {
+        /* the readahead worker holds the whole file, feed it in windows */
+        (*rd_addbegin)(st, full + skipbytes);
+        for(o = 0; o < dsize; o += r) {
+            r = dsize - o > (long int)sizeof(strmbuf) ? sizeof(strmbuf) : (size_t)(dsize - o);
+            (*rd_addchunk)(data + o, (int)r);
+        }
+        (*rd_addend)();
+        return;
+    }
+    if(S_ISREG(st->st_mode) && rd_addbegin && (f = fopen(full, "rb"))) {
+        /* stream the file in fixed size windows instead of reading it in whole */
+        (*rd_addbegin)(st, full + skipbytes);
+        while((r = fread(strmbuf, 1, sizeof(strmbuf), f)) > 0)
+            (*rd_addchunk)(strmbuf, (int)r);
+        fclose(f);
+        (*rd_addend)();
+        return;
+    }
+    if(S_ISREG(st->st_mode) && data) {
+        (*rd_add)(st, full + skipbytes, data, dsize);
+        return;
+    }
+    tmp = NULL; read_size = 0;
+    if(S_ISREG(st->st_mode)) tmp = readfileall(full); else
+    if(S_ISLNK(st->st_mode)) {
+        tmp = malloc(MAXPATH); if(!tmp) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
+        read_size=readlink(full,(char*)tmp,MAXPATH-1); tmp[read_size]=0;
+    }
+    (*rd_add)(st, full + skipbytes, tmp, read_size);
+    if(tmp) free(tmp);
+}
+
+#ifndef __WIN32__
+/* per directory preload budget; once spent, further files are only advised */
+#define WALK_READAHEAD (64*1024*1024L)
+/* files bigger than this are never preloaded, the packer streams them */
+#define WALK_MAXPRELOAD (8*1024*1024L)
+
+/**
+ * One entry of the parallel directory walk
+ */
+typedef struct {
+    char *full;                 /* on-disk path */
+    struct stat st;
+    unsigned char *data;        /* preloaded file contents or NULL */
+    long int size;
+    uint32_t crc;               /* content hash for the dedup index */
+    int hashed;
+    int err;                    /* stat failed, entry is skipped */
+} walkent_t;
+
+/**
+ * Work shared by the walker pool: entries are claimed one by one
+ */
+typedef struct {
+    walkent_t *ent;
+    int num, next;
+    long int budget;            /* remaining preload bytes */
+    pthread_mutex_t lock;
+} walk_t;
+
+/**
+ * Stat and read ahead of the packer. On a cold cache the round trips of many
+ * small files dominate the walk, doing them on a few threads (and telling the
+ * kernel early what's coming with posix_fadvise) makes ingestion bandwidth
+ * bound. Content hashes for the dedup index are computed here too
+ */
+static void *walkworker(void *data)
+{
+    walk_t *w = (walk_t*)data;
+    walkent_t *e;
+    unsigned char wbuf[65536];
+    long int got, n;
+    int i, fd;
+    while(1) {
+        pthread_mutex_lock(&w->lock);
+        i = w->next++;
+        pthread_mutex_unlock(&w->lock);
+        if(i >= w->num) break;
+        e = &w->ent[i];
+        if(stat(e->full, &e->st)) { e->err = 1; continue; }
+        if(!S_ISREG(e->st.st_mode) || !e->st.st_size) continue;
+        if((fd = open(e->full, O_RDONLY)) < 0) continue;
+#ifdef POSIX_FADV_WILLNEED
+        posix_fadvise(fd, 0, e->st.st_size, POSIX_FADV_WILLNEED);
+#endif
+        if((long int)e->st.st_size <= WALK_MAXPRELOAD) {
+            pthread_mutex_lock(&w->lock);
+            if(w->budget >= (long int)e->st.st_size) {
+                w->budget -= (long int)e->st.st_size;
+                e->data = malloc(e->st.st_size);
+            }
+            pthread_mutex_unlock(&w->lock);
+        }
+        if(e->data) {
+            for(got = 0; got < (long int)e->st.st_size; got += n) {
+                n = read(fd, e->data + got, e->st.st_size - got);
+                if(n < 1) break;
+            }
+            if(got != (long int)e->st.st_size) { free(e->data); e->data = NULL; }
+            else {
+                e->size = got;
+                if(rd_addlink) { e->crc = crc32_calc(e->data, (int)got); e->hashed = 1; }
+            }
+        }
+        if(!e->data && rd_addlink) {
+            lseek(fd, 0, SEEK_SET);
+            e->crc = 0;
+            while((n = read(fd, wbuf, sizeof(wbuf))) > 0) e->crc = crc32_cont(e->crc, wbuf, (int)n);
+            e->hashed = 1;
+        }
+        close(fd);
+    }
+    return NULL;
+}
+
+/**
+ * Sorted order makes the walk (and with it every image byte) independent of
+ * readdir order, so the same tree always packs to the same image
+ */
+static int walk_entcmp(const void *a, const void *b)
+{
+    return strcmp(((const walkent_t*)a)->full, ((const walkent_t*)b)->full);
+}
+#endif
+
+/**
+ * Recursively parse a directory
+ */
+void parsedir(char *directory, int parent)
+{
+    DIR *dir;
+    struct dirent *ent;
+    char full[MAXPATH];
+#ifndef __WIN32__
+    walk_t w;
+    walkent_t *e;
+    pthread_t wth[64];
+    int i, nt, thr[64], cap;
+#else
+    struct stat st;
+#endif
+
+    if(!parent) { dedup_free(); if(!fs_out) fs_reserve(fs_len + parsedirsize(directory) + 1024); }
+    if ((dir = opendir(directory)) == NULL) return;
+#ifndef __WIN32__
+    /* snapshot the directory, then let a small pool stat and read ahead */
+    memset(&w, 0, sizeof(w));
+    cap = 64;
+    w.ent = (walkent_t*)malloc(cap * sizeof(walkent_t));
+    if(!w.ent) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
+    while ((ent = readdir(dir)) != NULL) {
+        if(!parent && (!strcmp(ent->d_name, ".") || !strcmp(ent->d_name, ".."))) continue;
+        if(w.num == cap) {
+            cap <<= 1;
+            w.ent = (walkent_t*)realloc(w.ent, cap * sizeof(walkent_t));
+            if(!w.ent) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
+        }
+        e = &w.ent[w.num];
+        memset(e, 0, sizeof(walkent_t));
+        full[0] = 0;
+        strncat(full, directory, sizeof(full)-1);
+        strncat(full, "/", sizeof(full)-1);
+        strncat(full, ent->d_name, sizeof(full)-1);
+        e->full = (char*)malloc(strlen(full) + 1);
+        if(!e->full) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
+        strcpy(e->full, full);
+        w.num++;
+    }
+    closedir(dir);
+    qsort(w.ent, w.num, sizeof(walkent_t), walk_entcmp);
+    w.budget = WALK_READAHEAD;
+    pthread_mutex_init(&w.lock, NULL);
+    nt = initrd_walkers > 64 ? 64 : initrd_walkers;
+    if(nt > w.num) nt = w.num;
+    /* the main thread always works too, extra threads are best effort */
+    for(i = 0; i + 1 < nt; i++) thr[i] = !pthread_create(&wth[i], NULL, walkworker, &w);
+    walkworker(&w);
+    for(i = 0; i + 1 < nt; i++) if(thr[i]) pthread_join(wth[i], NULL);
+    pthread_mutex_destroy(&w.lock);
+    for(i = 0; i < w.num; i++) {
+        e = &w.ent[i];
+        if(!e->err) parseent(e->full, &e->st, parent, e->data, e->size, e->crc, e->hashed);
+        if(e->data) free(e->data);
+        free(e->full);
+    }
+    free(w.ent);
+#else
+    while ((ent = readdir(dir)) != NULL) {
+        if(!parent && (!strcmp(ent->d_name, ".") || !strcmp(ent->d_name, ".."))) continue;
+        full[0] = 0;
+        strncat(full, directory, sizeof(full)-1);
+        strncat(full, "/", sizeof(full)-1);
+        strncat(full, ent->d_name, sizeof(full)-1);
+        if(stat(full, &st)) continue;
+        parseent(full, &st, parent, NULL, 0, 0, 0);
+    }
+    closedir(dir);
+#endif
+}
+
+#ifndef __WIN32__
+/**
+ * One independently deflated block of the initrd (pigz-style)
+ */
+typedef struct {
+    unsigned char *in;          /* uncompressed input slice */
+    unsigned char *out;         /* raw deflate output */
+    unsigned long int inlen;
+    unsigned long int outlen;   /* in: capacity, out: bytes produced */
+    uint32_t crc;
+    int last;                   /* last block gets Z_FINISH, others Z_FULL_FLUSH */
+    int err;
+    int thr;                    /* got its own thread, needs a join */
+} gzblock_t;
+
+/**
+ * Deflate one block on its own thread. Z_FULL_FLUSH aligns the output on a
+ * byte boundary without a final block, so the raw streams simply concatenate
+ */
+static void *gzblockthread(void *data)
+{
+    gzblock_t *blk = (gzblock_t*)data;
+    z_stream zs;
+    int ret;
+    memset(&zs, 0, sizeof(z_stream));
+    if(deflateInit2(&zs, 9, Z_DEFLATED, -MAX_WBITS, 9, Z_DEFAULT_STRATEGY) != Z_OK) { blk->err = 1; return NULL; }
+    zs.next_in = blk->in; zs.avail_in = blk->inlen;
+    zs.next_out = blk->out; zs.avail_out = blk->outlen;
+    ret = deflate(&zs, blk->last ? Z_FINISH : Z_FULL_FLUSH);
+    if((blk->last ? ret != Z_STREAM_END : ret != Z_OK) || zs.avail_in) blk->err = 1;
+    blk->outlen = zs.total_out;
+    deflateEnd(&zs);
+    blk->crc = crc32(0, blk->in, blk->inlen);
+    return NULL;
 }
+#endif
 
 /**
  * Compress the initrd image
@@ -155,7 +678,65 @@ void initrdcompress()
     unsigned char *initrdgz;
     unsigned long int initrdgz_len = 0;
     uint32_t crc;
+#ifndef __WIN32__
+    pthread_t *th;
+    gzblock_t *blk;
+    unsigned long int blksiz, o;
+    int i, nb, err = 0;
+#endif
     if(!initrd_gzip || !fs_len || !fs_base || (fs_base[0] == 0x1f && fs_base[1] == 0x8b)) return;
+#ifndef __WIN32__
+    /* parallel mode: cut the input into independent blocks, deflate them on a
+     * thread pool and stitch the streams into one gzip. Each block is
+     * compressed with a fresh dictionary, costing a fraction of a percent in
+     * ratio, but scaling with the number of cores */
+    if(initrd_threads > 1 && fs_len > 1024*1024) {
+        nb = initrd_threads;
+        blksiz = ((unsigned long int)fs_len + nb - 1) / nb;
+        if(blksiz < 256*1024) { blksiz = 256*1024; nb = ((unsigned long int)fs_len + blksiz - 1) / blksiz; }
+        th = malloc(nb * sizeof(pthread_t));
+        blk = malloc(nb * sizeof(gzblock_t));
+        if(!th || !blk) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
+        for(i = 0; i < nb; i++) {
+            blk[i].in = fs_base + i * blksiz;
+            blk[i].inlen = i == nb - 1 ? fs_len - i * blksiz : blksiz;
+            blk[i].outlen = compressBound(blk[i].inlen) + 16;
+            blk[i].out = malloc(blk[i].outlen);
+            if(!blk[i].out) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
+            blk[i].crc = 0; blk[i].last = (i == nb - 1); blk[i].err = 0; blk[i].thr = 1;
+            if(pthread_create(&th[i], NULL, gzblockthread, &blk[i])) { blk[i].thr = 0; gzblockthread(&blk[i]); }
+        }
+        initrdgz_len = 0; crc = 0;
+        for(i = 0; i < nb; i++) {
+            if(blk[i].thr) pthread_join(th[i], NULL);
+            err |= blk[i].err;
+            initrdgz_len += blk[i].outlen;
+        }
+        free(th);
+        if(!err) {
+            initrdgz = malloc(initrdgz_len + 18);
+            if(!initrdgz) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
+            memset(initrdgz, 0, 10);
+            initrdgz[0] = 0x1f; initrdgz[1] = 0x8b; initrdgz[2] = 0x8; initrdgz[9] = 3;
+            memcpy(initrdgz + 4, &t, 4);
+            for(o = 10, i = 0; i < nb; i++) {
+                memcpy(initrdgz + o, blk[i].out, blk[i].outlen); o += blk[i].outlen;
+                crc = i ? crc32_combine(crc, blk[i].crc, blk[i].inlen) : blk[i].crc;
+                free(blk[i].out);
+            }
+            memcpy(initrdgz + o, &crc, 4);
+            memcpy(initrdgz + o + 4, &fs_len, 4);
+            free(blk);
+            free(fs_base);
+            fs_base = initrdgz;
+            fs_len = fs_cap = o + 8;
+            return;
+        }
+        /* a worker failed, fall back to the single threaded path */
+        for(i = 0; i < nb; i++) free(blk[i].out);
+        free(blk);
+    }
+#endif
     initrdgz_len = compressBound(fs_len);
     initrdgz = malloc(initrdgz_len);
     if(!initrdgz) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
@@ -164,6 +745,7 @@ void initrdcompress()
         crc = crc32(0,fs_base, fs_len);
         fs_base = realloc(fs_base, initrdgz_len + 18);
         if(!fs_base) { fprintf(stderr,"mkbootimg: %s\r\n",lang[ERR_MEM]); exit(1); }
+        fs_cap = initrdgz_len + 18;
         memset(fs_base, 0, 10);
         fs_base[0] = 0x1f; fs_base[1] = 0x8b; fs_base[2] = 0x8; fs_base[9] = 3;
         memcpy(fs_base + 4, &t, 4);
@@ -189,7 +771,7 @@ void initrduncompress()
     if(uncompress(buf,&len,fs_base,fs_len) == Z_OK && len > 0) {
         free(fs_base);
         fs_base = buf;
-        fs_len = len;
+        fs_len = fs_cap = len;
     } else
         free(buf);
 }
@@ -231,9 +813,81 @@ uint32_t crc32c_lookup[256]={
     0xF36E6F75L, 0x0105EC76L, 0x12551F82L, 0xE03E9C81L, 0x34F4F86AL, 0xC69F7B69L, 0xD5CF889DL, 0x27A40B9EL,
     0x79B737BAL, 0x8BDCB4B9L, 0x988C474DL, 0x6AE7C44EL, 0xBE2DA0A5L, 0x4C4623A6L, 0x5F16D052L, 0xAD7D5351L
 };
-uint32_t crc32_calc(unsigned char *start,int length)
+/**
+ * derived tables for the slice-by-8 loop, generated from crc32c_lookup
+ */
+static uint32_t crc32c_slice[8][256];
+
+/**
+ * Build the slice-by-8 tables. Must be called from main() before any worker
+ * thread spawns, the checksum itself runs on several threads and building
+ * the tables lazily in there would race
+ */
+void crc32c_init()
+{
+    uint32_t one;
+    int i, j;
+    for(i = 0; i < 256; i++) {
+        one = crc32c_lookup[i];
+        crc32c_slice[0][i] = one;
+        for(j = 1; j < 8; j++) {
+            one = (one >> 8) ^ crc32c_lookup[one & 0xff];
+            crc32c_slice[j][i] = one;
+        }
+    }
+}
+
+/**
+ * Continue a CRC32c over the next chunk, so large files can be hashed in
+ * fixed size windows. Pass the previous return value (0 on the first call)
+ */
+uint32_t crc32_cont(uint32_t crc32_val, unsigned char *start, int length)
 {
-    uint32_t crc32_val=0;
+    uint32_t one, two;
+#if defined(__x86_64__) && defined(__GNUC__)
+    /* runtime dispatched hardware path, the SSE4.2 crc32 instruction uses the
+     * same Castagnoli polynomial as the table loop */
+    static int hwcrc = -1;
+    unsigned long int q, c;
+    if(hwcrc < 0) hwcrc = __builtin_cpu_supports("sse4.2");
+    if(hwcrc) {
+        c = crc32_val;
+        while(length >= 8) {
+            memcpy(&q, start, 8);
+            __asm__("crc32q %1, %0" : "+r"(c) : "rm"(q));
+            start += 8; length -= 8;
+        }
+        crc32_val = (uint32_t)c;
+        while(length--)
+            __asm__("crc32b %1, %0" : "+r"(crc32_val) : "rm"(*start++));
+        return crc32_val;
+    }
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+    unsigned long int q;
+    while(length >= 8) {
+        memcpy(&q, start, 8);
+        __asm__("crc32cx %w0, %w0, %x1" : "+r"(crc32_val) : "r"(q));
+        start += 8; length -= 8;
+    }
+    while(length--)
+        __asm__("crc32cb %w0, %w0, %w1" : "+r"(crc32_val) : "r"((uint32_t)*start++));
+    return crc32_val;
+#endif
+    /* portable slice-by-8, reads eight bytes per iteration instead of one */
+    while(length >= 8) {
+        memcpy(&one, start, 4); memcpy(&two, start + 4, 4);
+        one ^= crc32_val;
+        crc32_val = crc32c_slice[7][one & 0xff] ^ crc32c_slice[6][(one >> 8) & 0xff] ^
+                    crc32c_slice[5][(one >> 16) & 0xff] ^ crc32c_slice[4][one >> 24] ^
+                    crc32c_slice[3][two & 0xff] ^ crc32c_slice[2][(two >> 8) & 0xff] ^
+                    crc32c_slice[1][(two >> 16) & 0xff] ^ crc32c_slice[0][two >> 24];
+        start += 8; length -= 8;
+    }
     while(length--) crc32_val=(crc32_val>>8)^crc32c_lookup[(crc32_val&0xff)^(unsigned char)*start++];
     return crc32_val;
 }
+
+uint32_t crc32_calc(unsigned char *start,int length)
+{
+    return crc32_cont(0, start, length);
+}